@@ -0,0 +1,102 @@
+#include "Adafruit_GFX.h"
+#include <cstdlib>
+
+namespace {
+// Deterministic stand-in for a 5x8 font column: blank for space, dense otherwise
+uint8_t glyphColumn(unsigned char c, int column) {
+  if (c == ' ') {
+    return 0;
+  }
+  uint32_t hash = (c * 2654435761u) >> (column * 5);
+  return static_cast<uint8_t>((hash & 0x7F) | 0x01);
+}
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) {
+    drawPixel(x, y + i, color);
+  }
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) {
+    drawPixel(x + i, y, color);
+  }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = x; i < x + w; i++) {
+    drawFastVLine(i, y, h, color);
+  }
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  // Bresenham, as in Adafruit_GFX::writeLine
+  int16_t dx = abs(x1 - x0);
+  int16_t dy = -abs(y1 - y0);
+  int16_t sx = x0 < x1 ? 1 : -1;
+  int16_t sy = y0 < y1 ? 1 : -1;
+  int16_t err = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    int16_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  for (int16_t dx = -r; dx <= r; dx++) {
+    int16_t span = 0;
+    while ((span + 1) * (span + 1) + dx * dx <= r * r) {
+      span++;
+    }
+    drawFastVLine(x0 + dx, y0 - span, 2 * span + 1, color);
+  }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  for (int8_t i = 0; i < 5; i++) {
+    uint8_t line = glyphColumn(c, i);
+    for (int8_t j = 0; j < 8; j++, line >>= 1) {
+      if (line & 1) {
+        if (size == 1) {
+          drawPixel(x + i, y + j, color);
+        } else {
+          fillRect(x + i * size, y + j * size, size, size, color);
+        }
+      } else if (bg != color) {
+        if (size == 1) {
+          drawPixel(x + i, y + j, bg);
+        } else {
+          fillRect(x + i * size, y + j * size, size, size, bg);
+        }
+      }
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += textsize_y * 8;
+  } else if (c != '\r') {
+    if (wrap && (cursor_x + textsize_x * 6) > _width) {
+      cursor_x = 0;
+      cursor_y += textsize_y * 8;
+    }
+    drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x);
+    cursor_x += textsize_x * 6;
+  }
+  return 1;
+}
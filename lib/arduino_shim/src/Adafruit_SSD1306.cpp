@@ -0,0 +1,101 @@
+#include "Adafruit_SSD1306.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+const size_t WIRE_MAX = 32;  // Arduino Wire transmit buffer size
+}
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin,
+                                   uint32_t clkDuring, uint32_t clkAfter) :
+    Adafruit_GFX(w, h),
+    wire(twi),
+    wireClk(clkDuring),
+    restoreClk(clkAfter) {
+  (void)rst_pin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+  free(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t addr, bool reset, bool periphBegin) {
+  (void)switchvcc;
+  (void)reset;
+  (void)periphBegin;
+  if (!buffer) {
+    buffer = static_cast<uint8_t*>(malloc(_width * ((_height + 7) / 8)));
+    if (!buffer) {
+      return false;
+    }
+  }
+  if (addr) {
+    i2caddr = addr;
+  }
+  clearDisplay();
+  return true;
+}
+
+void Adafruit_SSD1306::ssd1306_command1(uint8_t c) {
+  wire->beginTransmission(i2caddr);
+  wire->write(static_cast<uint8_t>(0x00));
+  wire->write(c);
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_commandList(const uint8_t* c, uint8_t n) {
+  wire->beginTransmission(i2caddr);
+  wire->write(static_cast<uint8_t>(0x00));
+  size_t bytesOut = 1;
+  while (n--) {
+    if (bytesOut >= WIRE_MAX) {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write(static_cast<uint8_t>(0x00));
+      bytesOut = 1;
+    }
+    wire->write(*c++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::display() {
+  static const uint8_t dlist[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+  ssd1306_commandList(dlist, sizeof(dlist));
+  ssd1306_command1(_width - 1);
+
+  size_t count = _width * ((_height + 7) / 8);
+  const uint8_t* ptr = buffer;
+  wire->beginTransmission(i2caddr);
+  wire->write(static_cast<uint8_t>(0x40));
+  size_t bytesOut = 1;
+  while (count--) {
+    if (bytesOut >= WIRE_MAX) {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write(static_cast<uint8_t>(0x40));
+      bytesOut = 1;
+    }
+    wire->write(*ptr++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  memset(buffer, 0, _width * ((_height + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= _width || y < 0 || y >= _height) {
+    return;
+  }
+  uint8_t* byte = &buffer[x + (y / 8) * _width];
+  uint8_t bit = 1 << (y & 7);
+  switch (color) {
+    case SSD1306_WHITE:   *byte |= bit;  break;
+    case SSD1306_BLACK:   *byte &= ~bit; break;
+    case SSD1306_INVERSE: *byte ^= bit;  break;
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK   0
+#define SSD1306_WHITE   1
+#define SSD1306_INVERSE 2
+
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_COLUMNADDR   0x21
+#define SSD1306_PAGEADDR     0x22
+
+// Framebuffer-only SSD1306: display() pushes the buffer through the counting
+// Wire stand-in with the same framing as the real driver
+class Adafruit_SSD1306 : public Adafruit_GFX {
+protected:
+    TwoWire* wire;
+    uint8_t* buffer = nullptr;
+    int8_t i2caddr = 0x3C;
+    uint32_t wireClk;
+    uint32_t restoreClk;
+
+    void ssd1306_command1(uint8_t c);
+    void ssd1306_commandList(const uint8_t* c, uint8_t n);
+
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
+               bool reset = true, bool periphBegin = true);
+    void display();
+    void clearDisplay();
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void ssd1306_command(uint8_t c) { ssd1306_command1(c); }
+    uint8_t* getBuffer() { return buffer; }
+};
@@ -0,0 +1,71 @@
+#include "Arduino.h"
+#include "arduino_shim.h"
+#include <deque>
+
+namespace {
+uint64_t currentMicros = 0;
+int analogValues[64] = {0};
+int digitalValues[64] = {0};
+FILE* serialOutput = stdout;
+std::deque<uint8_t> serialInput;
+}
+
+HardwareSerial Serial;
+
+namespace shim {
+
+void setMicros(uint64_t us) { currentMicros = us; }
+void setMillis(uint64_t ms) { currentMicros = ms * 1000; }
+void advanceMicros(uint64_t us) { currentMicros += us; }
+uint64_t getMicros() { return currentMicros; }
+
+void setAnalogValue(uint8_t pin, int value) { analogValues[pin & 63] = value; }
+void setDigitalValue(uint8_t pin, int value) { digitalValues[pin & 63] = value; }
+
+void setSerialOutput(FILE* out) { serialOutput = out; }
+void pushSerialInput(const std::string& data) { serialInput.insert(serialInput.end(), data.begin(), data.end()); }
+
+} // namespace shim
+
+unsigned long millis() { return static_cast<unsigned long>(currentMicros / 1000); }
+unsigned long micros() { return static_cast<unsigned long>(currentMicros); }
+void delay(unsigned long ms) { currentMicros += static_cast<uint64_t>(ms) * 1000; }
+void delayMicroseconds(unsigned int us) { currentMicros += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  // Pulled-up inputs idle high, like the joystick lines on the board
+  if (mode == INPUT_PULLUP) {
+    digitalValues[pin & 63] = HIGH;
+  }
+}
+
+int digitalRead(uint8_t pin) { return digitalValues[pin & 63]; }
+void digitalWrite(uint8_t pin, uint8_t value) { digitalValues[pin & 63] = value; }
+uint16_t analogRead(uint8_t pin) { return static_cast<uint16_t>(analogValues[pin & 63]); }
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (serialOutput) {
+    fputc(c, serialOutput);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialOutput) {
+    fwrite(buffer, 1, size, serialOutput);
+  }
+  return size;
+}
+
+int HardwareSerial::available() { return static_cast<int>(serialInput.size()); }
+
+int HardwareSerial::read() {
+  if (serialInput.empty()) {
+    return -1;
+  }
+  int c = serialInput.front();
+  serialInput.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() { return serialInput.empty() ? -1 : serialInput.front(); }
@@ -0,0 +1,48 @@
+#pragma once
+
+// Host (native) replacement for the Arduino core header.
+// Provides just enough of the ESP32 Arduino API for the firmware modules
+// to compile on Linux; see arduino_shim.h for the host-side controls.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+class __FlashStringHelper;
+#define F(string_literal) (string_literal)
+#define PROGMEM
+#define IRAM_ATTR
+#define pgm_read_byte(addr) (*(const unsigned char*)(addr))
+
+// By-value min/max like the Arduino core (avoids odr-using static const members)
+template <typename T, typename U>
+constexpr typename std::common_type<T, U>::type min(T a, U b) { return (b < a) ? b : a; }
+template <typename T, typename U>
+constexpr typename std::common_type<T, U>::type max(T a, U b) { return (a < b) ? b : a; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int  digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint16_t analogRead(uint8_t pin);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Stream.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+// File handle over an in-memory SPIFFS image entry
+class File : public Stream {
+private:
+    std::shared_ptr<std::vector<uint8_t>> data;
+    size_t offset = 0;
+    bool writable = false;
+
+public:
+    File() {}
+    File(std::shared_ptr<std::vector<uint8_t>> content, size_t start, bool canWrite) :
+        data(content), offset(start), writable(canWrite) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    int available() override { return data ? static_cast<int>(data->size() - offset) : 0; }
+    int read() override { return available() > 0 ? (*data)[offset++] : -1; }
+    int peek() override { return available() > 0 ? (*data)[offset] : -1; }
+    size_t read(uint8_t* buffer, size_t size) { return readBytes(buffer, size); }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const { return offset; }
+    size_t size() const { return data ? data->size() : 0; }
+    void flush() {}
+    void close() { data.reset(); offset = 0; }
+
+    explicit operator bool() const { return static_cast<bool>(data); }
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+    bool remove(const char* path);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
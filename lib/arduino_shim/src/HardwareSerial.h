@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Stream.h"
+
+// Serial port backed by a host FILE* sink and an in-memory input queue
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    void flush() {}
+    size_t setTxBufferSize(size_t size) { return size; }
+    int availableForWrite() { return 4096; }  // Host output never backs up
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
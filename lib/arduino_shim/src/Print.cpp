@@ -0,0 +1,41 @@
+#include "Print.h"
+#include <cstdarg>
+#include <cstdio>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(long number, int base) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%ld", number);
+  return write(buf);
+}
+
+size_t Print::print(unsigned long number, int base) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%lu", number);
+  return write(buf);
+}
+
+size_t Print::print(double number, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, number);
+  return write(buf);
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  return write(reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(len) < sizeof(buf) ? len : sizeof(buf) - 1);
+}
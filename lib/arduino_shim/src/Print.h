@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+
+// Arduino Print base - derived classes only implement write()
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* str) { return write(reinterpret_cast<const uint8_t*>(str), strlen(str)); }
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str) { return write(str.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int number, int base = DEC) { return print(static_cast<long>(number), base); }
+    size_t print(unsigned int number, int base = DEC) { return print(static_cast<unsigned long>(number), base); }
+    size_t print(long number, int base = DEC);
+    size_t print(unsigned long number, int base = DEC);
+    size_t print(double number, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& value) { size_t n = print(value); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
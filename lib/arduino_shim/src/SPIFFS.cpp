@@ -0,0 +1,87 @@
+#include "SPIFFS.h"
+#include "arduino_shim.h"
+#include <map>
+
+namespace {
+// Whole "flash" image kept in RAM so replays run at memory speed
+std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+}
+
+SPIFFSFS SPIFFS;
+
+namespace fs {
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!data || !writable) {
+    return 0;
+  }
+  if (offset + size > data->size()) {
+    data->resize(offset + size);
+  }
+  memcpy(data->data() + offset, buffer, size);
+  offset += size;
+  return size;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!data) {
+    return false;
+  }
+  size_t base = (mode == SeekSet) ? 0 : (mode == SeekCur) ? offset : data->size();
+  if (base + pos > data->size()) {
+    return false;
+  }
+  offset = base + pos;
+  return true;
+}
+
+File FS::open(const char* path, const char* mode) {
+  auto it = files.find(path);
+  if (mode[0] == 'r') {
+    if (it == files.end()) {
+      return File();
+    }
+    return File(it->second, 0, false);
+  }
+
+  if (it == files.end() || mode[0] == 'w') {
+    files[path] = std::make_shared<std::vector<uint8_t>>();
+    it = files.find(path);
+  }
+  return File(it->second, it->second->size(), true);
+}
+
+bool FS::exists(const char* path) {
+  return files.count(path) > 0;
+}
+
+bool FS::remove(const char* path) {
+  return files.erase(path) > 0;
+}
+
+} // namespace fs
+
+size_t SPIFFSFS::usedBytes() const {
+  size_t used = 0;
+  for (const auto& entry : files) {
+    used += entry.second->size();
+  }
+  return used;
+}
+
+namespace shim {
+
+bool readSpiffsFile(const char* path, std::vector<uint8_t>& out) {
+  auto it = files.find(path);
+  if (it == files.end()) {
+    return false;
+  }
+  out = *it->second;
+  return true;
+}
+
+void writeSpiffsFile(const char* path, const std::vector<uint8_t>& data) {
+  files[path] = std::make_shared<std::vector<uint8_t>>(data);
+}
+
+} // namespace shim
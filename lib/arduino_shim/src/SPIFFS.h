@@ -0,0 +1,13 @@
+#pragma once
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+    void end() {}
+    size_t totalBytes() const { return 1472 * 1024; }
+    size_t usedBytes() const;
+};
+
+extern SPIFFSFS SPIFFS;
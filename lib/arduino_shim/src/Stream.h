@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Print.h"
+
+// Arduino Stream - readable Print
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length && available() > 0) {
+            buffer[count++] = static_cast<uint8_t>(read());
+        }
+        return count;
+    }
+
+    String readStringUntil(char terminator) {
+        String result;
+        while (available() > 0) {
+            int c = read();
+            if (c == terminator) {
+                break;
+            }
+            result += static_cast<char>(c);
+        }
+        return result;
+    }
+};
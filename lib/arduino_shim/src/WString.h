@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+
+// Thin std::string-backed stand-in for the Arduino String class
+class String {
+private:
+    std::string value;
+
+public:
+    String() {}
+    String(const char* str) : value(str ? str : "") {}
+    String(const std::string& str) : value(str) {}
+    String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+
+    unsigned int length() const { return value.length(); }
+    const char* c_str() const { return value.c_str(); }
+    char operator[](unsigned int index) const { return value[index]; }
+
+    String& operator+=(const String& other) { value += other.value; return *this; }
+    String& operator+=(const char* str) { value += str; return *this; }
+    String& operator+=(char c) { value += c; return *this; }
+
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* str) const { return value == str; }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool startsWith(const char* prefix) const { return value.rfind(prefix, 0) == 0; }
+
+    void trim() {
+        size_t begin = value.find_first_not_of(" \t\r\n");
+        size_t end = value.find_last_not_of(" \t\r\n");
+        value = (begin == std::string::npos) ? "" : value.substr(begin, end - begin + 1);
+    }
+    long toInt() const { return std::strtol(value.c_str(), nullptr, 10); }
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// I2C bus stand-in that only counts traffic, so display push cost is measurable
+class TwoWire {
+private:
+    uint32_t clock = 100000;
+    size_t bytesWritten = 0;
+    size_t transactions = 0;
+
+public:
+    bool begin() { return true; }
+    void setClock(uint32_t frequency) { clock = frequency; }
+    uint32_t getClock() const { return clock; }
+
+    void beginTransmission(uint8_t address) { (void)address; transactions++; }
+    size_t write(uint8_t data) { (void)data; bytesWritten++; return 1; }
+    size_t write(const uint8_t* data, size_t size) { (void)data; bytesWritten += size; return size; }
+    uint8_t endTransmission(bool sendStop = true) { (void)sendStop; return 0; }
+
+    // Host-only traffic counters
+    size_t getBytesWritten() const { return bytesWritten; }
+    size_t getTransactions() const { return transactions; }
+    void resetCounters() { bytesWritten = 0; transactions = 0; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Host-side control surface of the Arduino shim.
+// Lets native drivers (replay, benchmarks) steer the simulated clock,
+// pin levels and serial/SPIFFS contents the firmware code observes.
+namespace shim {
+
+// Simulated clock - millis()/micros() only move when told to (or by delay())
+void setMicros(uint64_t us);
+void setMillis(uint64_t ms);
+void advanceMicros(uint64_t us);
+uint64_t getMicros();
+
+// Simulated pin levels returned by analogRead()/digitalRead()
+void setAnalogValue(uint8_t pin, int value);
+void setDigitalValue(uint8_t pin, int value);
+
+// Serial output sink (defaults to stdout, nullptr discards)
+void setSerialOutput(FILE* out);
+// Bytes the firmware will see through Serial.read()
+void pushSerialInput(const std::string& data);
+
+// Direct access to the in-memory SPIFFS image
+bool readSpiffsFile(const char* path, std::vector<uint8_t>& out);
+void writeSpiffsFile(const char* path, const std::vector<uint8_t>& data);
+
+} // namespace shim
@@ -1,85 +1,378 @@
 #!/usr/bin/env python3
 """
 Automatic data saver - listens to serial port and saves data when recording stops.
-Usage: python3 scripts/auto_save_listener.py [port]
+Usage: python3 scripts/auto_save_listener.py [port] [--baud BAUD]
 
 This script runs in the background and automatically saves data to the data/
 directory whenever the ESP32 stops recording.
+
+Two dump protocols are understood:
+  - text:   CSV lines between ===DATA_START=== and ===DATA_END=== markers
+  - framed: CRC32-checked binary frames (see src/frame_codec.hpp); missing or
+            corrupted frames are requested again with "RESEND <seq>" and the
+            finished transfer is confirmed with "ACK" once the whole-file
+            CRC32 matches
 """
 
+import argparse
 import serial
+import struct
 import sys
 import os
+import zlib
 from datetime import datetime
 import time
 
-def listen_and_save(port='/dev/ttyUSB0', baudrate=115200):
+# Framed protocol constants (must match src/frame_codec.hpp)
+FRAME_SYNC = b'\xa5\x5a'
+FRAME_HEADER_SIZE = 7
+FRAME_TRAILER_SIZE = 4
+FRAME_MAX_PAYLOAD = 256
+FRAME_DUMP_START = 0x01
+FRAME_DUMP_DATA = 0x02
+FRAME_DUMP_END = 0x03
+DUMP_FORMAT_BINARY = 1
+DUMP_FORMAT_COMPRESSED = 2
+
+# Binary recording format (must match src/record_format.hpp)
+RECORD_HEADER = b'HBR\x00\x01\x0f'
+RECORD_HEADER_SIZE = 8
+RECORD_STRUCT = struct.Struct('<IhhhhBH')
+CSV_HEADER = 'timestamp,signal,peak,trough,threshold,beat_detected,bpm'
+
+# Compressed column format (must match src/column_codec.hpp)
+COLUMN_HEADER = b'HBC\x00\x01\x07'
+COLUMN_HEADER_SIZE = 8
+COLUMN_BLOCK_HEADER = struct.Struct('<HH')
+COLUMN_DELTA2 = 0x01
+COLUMN_ZERO_RUNS = 0x02
+# Field width and signedness of each column, in SampleRecord order
+COLUMN_TYPES = [(32, False), (16, True), (16, True), (16, True), (16, True), (8, False), (16, False)]
+
+# Don't repeat a resend request for the same frame more often than this
+RESEND_INTERVAL = 0.5
+
+
+def decode_binary_recording(data):
+    """Convert a binary recording to CSV lines."""
+    if data[:len(RECORD_HEADER)] != RECORD_HEADER:
+        raise ValueError("not a version 1 binary recording")
+
+    lines = [CSV_HEADER]
+    end = len(data) - (len(data) - RECORD_HEADER_SIZE) % RECORD_STRUCT.size
+    for offset in range(RECORD_HEADER_SIZE, end, RECORD_STRUCT.size):
+        timestamp, signal, peak, trough, threshold, flags, bpm = RECORD_STRUCT.unpack_from(data, offset)
+        lines.append(f"{timestamp},{signal},{peak},{trough},{threshold},{flags & 1},{bpm}")
+    return lines
+
+
+def read_varint(data, offset, end):
+    """Return (value, next offset) of the varint at offset."""
+    value = 0
+    for shift in range(0, 35, 7):
+        if offset >= end:
+            break
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7f) << shift
+        if not byte & 0x80:
+            return value, offset
+    raise ValueError("damaged compressed block")
+
+
+def decode_column(data, offset, end, count, bits, signed):
+    """Decode one column of a block, returns (values, next offset)."""
+    if offset >= end or data[offset] > (COLUMN_DELTA2 | COLUMN_ZERO_RUNS):
+        raise ValueError("damaged compressed block")
+    encoding = data[offset]
+    offset += 1
+
+    # Same uint32 wrap-around arithmetic as the firmware encoder
+    values = []
+    previous = previous_delta = zeros = 0
+    for _ in range(count):
+        if zeros:
+            zeros -= 1
+            symbol = 0
+        else:
+            symbol, offset = read_varint(data, offset, end)
+            if encoding & COLUMN_ZERO_RUNS and symbol == 0:
+                zeros, offset = read_varint(data, offset, end)
+        delta = (symbol >> 1) ^ -(symbol & 1)
+        if encoding & COLUMN_DELTA2:
+            delta += previous_delta
+        delta &= 0xffffffff
+        previous = (previous + delta) & 0xffffffff
+        previous_delta = delta
+
+        value = previous & ((1 << bits) - 1)
+        if signed and value >= 1 << (bits - 1):
+            value -= 1 << bits
+        values.append(value)
+    if zeros:
+        raise ValueError("damaged compressed block")
+    return values, offset
+
+
+def decode_compressed_recording(data):
+    """Convert a compressed column recording to CSV lines."""
+    if data[:len(COLUMN_HEADER)] != COLUMN_HEADER:
+        raise ValueError("not a version 1 compressed recording")
+
+    lines = [CSV_HEADER]
+    offset = COLUMN_HEADER_SIZE
+    while offset + COLUMN_BLOCK_HEADER.size <= len(data):
+        count, size = COLUMN_BLOCK_HEADER.unpack_from(data, offset)
+        offset += COLUMN_BLOCK_HEADER.size
+        end = offset + size
+        if end > len(data):
+            raise ValueError("truncated compressed block")
+        columns = []
+        for bits, signed in COLUMN_TYPES:
+            values, offset = decode_column(data, offset, end, count, bits, signed)
+            columns.append(values)
+        if offset != end:
+            raise ValueError("damaged compressed block")
+        for timestamp, signal, peak, trough, threshold, flags, bpm in zip(*columns):
+            lines.append(f"{timestamp},{signal},{peak},{trough},{threshold},{flags & 1},{bpm}")
+    return lines
+
+
+def save_lines(data_dir, lines):
+    """Save CSV lines to a timestamped file in data_dir."""
+    if not lines:
+        print("  No data received")
+        return
+
+    # Generate output filename with timestamp
+    timestamp = datetime.now().strftime('%Y-%m-%d_%H-%M-%S')
+    output_file = os.path.join(data_dir, f'measurement_{timestamp}.csv')
+
+    # Write data to file
+    with open(output_file, 'w') as f:
+        for data_line in lines:
+            f.write(data_line + '\n')
+
+    print(f"  Data saved to: {output_file}")
+    print(f"  Lines: {len(lines)}")
+    print()
+
+
+class FramedDump:
+    """Reassembles one framed dump and tracks which frames are still missing."""
+
+    def __init__(self):
+        self.frames = {}
+        self.frame_count = None
+        self.file_size = None
+        self.file_format = None
+        self.file_crc = None
+        self.highest_seq = -1
+        self.gaps = set()  # Frames known to be missing
+        self.requested = {}
+        self.corrupted = 0
+        self.resent = 0
+        self.refetched = False
+        self.acknowledged = False
+
+    def describe(self, payload, has_crc):
+        self.file_format = payload[0]
+        self.file_size, self.frame_count = struct.unpack_from('<IH', payload, 1)
+        if has_crc:
+            (self.file_crc,) = struct.unpack_from('<I', payload, 7)
+            # Frames after the newest one received are lost too
+            self.gaps.update(range(self.highest_seq + 1, self.frame_count))
+
+    def add(self, seq, payload):
+        if seq in self.requested:
+            self.resent += 1
+        self.frames[seq] = bytes(payload)
+        # Until the END frame arrives only gaps below the newest frame are known to be lost
+        if seq > self.highest_seq:
+            self.gaps.update(range(self.highest_seq + 1, seq))
+            self.highest_seq = seq
+        self.gaps.discard(seq)
+
+    def refetch(self):
+        """Drop every frame and treat the whole file as missing."""
+        self.frames = {}
+        self.gaps = set(range(self.frame_count))
+        self.requested = {}
+        self.refetched = True
+
+    def request_missing(self, ser):
+        now = time.monotonic()
+        for seq in sorted(self.gaps):
+            if now - self.requested.get(seq, 0) >= RESEND_INTERVAL:
+                ser.write(f"RESEND {seq}\n".encode())
+                self.requested[seq] = now
+
+    def complete(self):
+        return self.file_crc is not None and not self.gaps
+
+    def assemble(self):
+        return b''.join(self.frames[seq] for seq in range(self.frame_count))[:self.file_size]
+
+
+def finish_framed_dump(ser, dump, data_dir):
+    """Check a complete framed dump against the file CRC, then acknowledge it and
+    save it as CSV. On a mismatch all frames are requested again once; if that
+    fails too the dump is discarded without ACK and the firmware times out.
+    Returns False while the dump is being fetched again."""
+    data = dump.assemble()
+    if zlib.crc32(data) != dump.file_crc:
+        if dump.refetched:
+            print("  ERROR: File checksum mismatch after refetch, dump discarded")
+            return True
+        print("  WARNING: File checksum mismatch, requesting all frames again")
+        dump.refetch()
+        dump.request_missing(ser)
+        return False
+
+    ser.write(b"ACK\n")
+    dump.acknowledged = True
+    print(f"  Frames: {dump.frame_count}, corrupted: {dump.corrupted}, resent: {dump.resent}")
+    try:
+        if dump.file_format == DUMP_FORMAT_BINARY:
+            lines = decode_binary_recording(data)
+        elif dump.file_format == DUMP_FORMAT_COMPRESSED:
+            lines = decode_compressed_recording(data)
+        else:
+            lines = [line.rstrip('\r') for line in data.decode('utf-8', errors='ignore').split('\n') if line.strip()]
+    except ValueError as e:
+        print(f"  ERROR: {e}")
+        return True
+    save_lines(data_dir, lines)
+    return True
+
+
+def listen_and_save(port='/dev/ttyUSB0', baudrate=921600):
     """Listen to serial port and automatically save data when received."""
-    
+
     # Create data directory if it doesn't exist
     data_dir = './data/measurements'
     os.makedirs(data_dir, exist_ok=True)
-    
+
     try:
-        print(f"Connecting to ESP32 on port {port}...")
-        ser = serial.Serial(port, baudrate, timeout=1)
-        
+        print(f"Connecting to ESP32 on port {port} at {baudrate} baud...")
+        ser = serial.Serial(port, baudrate, timeout=0.05)
+
         # Wait for connection to stabilize
         time.sleep(1)
-        
+
         print("Connected! Listening for data...")
         print("Press Ctrl+C to stop\n")
-        
+
         recording_data = False
         data_lines = []
-        
+        dump = None
+        last_dump = None
+        buffer = bytearray()
+
         while True:
-            try:
-                if ser.in_waiting > 0:
-                    line = ser.readline().decode('utf-8', errors='ignore').strip()
-                    
-                    # Echo important messages
-                    if 'Recording started' in line or 'Recording stopped' in line:
-                        print(f"[ESP32] {line}")
-                    
-                    # Detect data dump markers
-                    if line == "===DATA_START===":
-                        recording_data = True
-                        data_lines = []
-                        print("→ Receiving data...")
+            chunk = ser.read(max(1, ser.in_waiting))
+            if not chunk:
+                continue
+            buffer += chunk
+
+            while buffer:
+                sync = buffer.find(FRAME_SYNC)
+                newline = buffer.find(b'\n')
+
+                if sync != -1 and (newline == -1 or sync < newline):
+                    # Binary frame (anything before it is the start of a text line)
+                    if len(buffer) < sync + FRAME_HEADER_SIZE:
+                        break
+                    length = int.from_bytes(buffer[sync + 5:sync + 7], 'little')
+                    if length > FRAME_MAX_PAYLOAD:
+                        # Corrupted header - skip the sync byte and resynchronise
+                        del buffer[:sync + 1]
                         continue
-                    elif line == "===DATA_END===":
-                        recording_data = False
-                        
-                        if data_lines:
-                            # Generate output filename with timestamp
-                            timestamp = datetime.now().strftime('%Y-%m-%d_%H-%M-%S')
-                            output_file = os.path.join(data_dir, f'measurement_{timestamp}.csv')
-                            
-                            # Write data to file
-                            with open(output_file, 'w') as f:
-                                for data_line in data_lines:
-                                    f.write(data_line + '\n')
-                            
-                            print(f"  Data saved to: {output_file}")
-                            print(f"  Lines: {len(data_lines)}")
-                            print()
-                        else:
-                            print("  No data received")
-                        
-                        data_lines = []
+                    end = sync + FRAME_HEADER_SIZE + length + FRAME_TRAILER_SIZE
+                    if len(buffer) < end:
+                        break
+
+                    frame = bytes(buffer[sync:end])
+                    del buffer[:end]
+                    frame_type = frame[2]
+                    seq = int.from_bytes(frame[3:5], 'little')
+                    payload = frame[FRAME_HEADER_SIZE:FRAME_HEADER_SIZE + length]
+
+                    if zlib.crc32(frame[2:FRAME_HEADER_SIZE + length]) != int.from_bytes(frame[-4:], 'little'):
+                        # Untrusted header, the gap is requested once later frames arrive
+                        if dump is not None:
+                            dump.corrupted += 1
+                        continue
+
+                    if frame_type == FRAME_DUMP_START:
+                        last_dump = None
+                        dump = FramedDump()
+                        dump.describe(payload, has_crc=False)
+                        print(f"→ Receiving data ({dump.file_size} bytes, {dump.frame_count} frames)...")
+                    elif frame_type == FRAME_DUMP_DATA:
+                        if dump is None and last_dump is not None:
+                            # Late retransmission of a dump that is already saved
+                            continue
+                        if dump is None:
+                            # START frame was lost, the END frame will describe the file
+                            dump = FramedDump()
+                            print("→ Receiving data...")
+                        dump.add(seq, payload)
+                        if dump.file_crc is None:
+                            dump.request_missing(ser)
+                    elif frame_type == FRAME_DUMP_END and dump is not None:
+                        dump.describe(payload, has_crc=True)
+                    elif frame_type == FRAME_DUMP_END and last_dump is not None:
+                        # Repeated END - our ACK got lost, confirm again (never for a discarded dump)
+                        if last_dump.acknowledged:
+                            ser.write(b"ACK\n")
                         continue
-                    
-                    # Collect data lines
-                    if recording_data and line:
-                        data_lines.append(line)
-                
-            except UnicodeDecodeError:
-                # Skip lines with encoding issues
-                pass
-            
-            time.sleep(0.01)  # Small delay to prevent CPU spinning
-            
+                    else:
+                        continue
+
+                    # Once the END frame is in, chase missing frames or finish up
+                    if dump.file_crc is not None:
+                        if dump.complete():
+                            if finish_framed_dump(ser, dump, data_dir):
+                                last_dump = dump
+                                dump = None
+                        else:
+                            dump.request_missing(ser)
+                    continue
+
+                if newline == -1:
+                    break
+
+                line = buffer[:newline].decode('utf-8', errors='ignore').strip()
+                del buffer[:newline + 1]
+
+                # Echo important messages
+                if 'Recording started' in line or 'Recording stopped' in line:
+                    print(f"[ESP32] {line}")
+
+                # Detect data dump markers
+                if line == "===DATA_START===":
+                    recording_data = True
+                    data_lines = []
+                    print("→ Receiving data...")
+                    continue
+                elif line == "===DATA_END===":
+                    recording_data = False
+                    save_lines(data_dir, data_lines)
+                    data_lines = []
+                    continue
+                elif line == "===DATA_ABORT===":
+                    # Dump interrupted by a new recording - discard partial data
+                    recording_data = False
+                    data_lines = []
+                    print("  Transfer aborted, partial data discarded")
+                    print()
+                    continue
+
+                # Collect data lines
+                if recording_data and line:
+                    data_lines.append(line)
+
     except serial.SerialException as e:
         print(f"\nERROR: Could not open serial port {port}")
         print(f"Details: {e}")
@@ -100,11 +393,16 @@ def listen_and_save(port='/dev/ttyUSB0', baudrate=115200):
         return False
 
 if __name__ == '__main__':
-    port = sys.argv[1] if len(sys.argv) > 1 else '/dev/ttyUSB0'
-    
+    parser = argparse.ArgumentParser(description='Save recordings dumped by the ESP32 heartbeat sensor')
+    parser.add_argument('port', nargs='?', default='/dev/ttyUSB0',
+                        help='Serial port (default: /dev/ttyUSB0)')
+    parser.add_argument('--baud', type=int, default=921600,
+                        help='Baud rate, must match SERIAL_BAUD_RATE in the firmware (default: 921600)')
+    args = parser.parse_args()
+
     print("=" * 60)
     print("ESP32 Heartbeat Sensor - Automatic Data Saver")
     print("=" * 60)
-    
-    success = listen_and_save(port)
+
+    success = listen_and_save(args.port, args.baud)
     sys.exit(0 if success else 1)
@@ -3,27 +3,102 @@
 Heartbeat Sensor Data Plotter
 Plots timestamp vs signal data from CSV files in the data directory and saves figures
 
-Usage: python plot_sensor_data.py [data_directory] [--beat-bpm]
+Usage: python plot_sensor_data.py [data_directory] [--beat-bpm] [--analysis DIR]
   --beat-bpm: Enable beat-based BPM calculation display (default: off)
+  --analysis: Read the summaries written by build/host/analyze into DIR
+              instead of parsing the CSVs with pandas (see make plot)
 """
 
 import os
 import sys
-import pandas as pd
+import json
 import matplotlib.pyplot as plt
 import numpy as np
 import glob
 import argparse
 from pathlib import Path
 
-def plot_sensor_data(data_dir="data", show_beat_bpm=True):
+# Column order of the recordings and of the analyzer's .samples.i32 files
+COLUMNS = ['timestamp', 'signal', 'peak', 'trough', 'threshold', 'beat_detected', 'bpm']
+
+
+def load_sessions_analysis(analysis_dir):
+    """
+    Load sessions summarized by build/host/analyze (see tools/analyze.cpp)
+
+    Returns a list of session dicts with time relative to the first sample
+    """
+    sessions = []
+    with open(os.path.join(analysis_dir, 'summary.jsonl'), 'r') as f:
+        for line in f:
+            summary = json.loads(line)
+            base = os.path.join(analysis_dir, summary['name'])
+            samples = np.fromfile(base + '.samples.i32', dtype='<i4').reshape(-1, len(COLUMNS))
+            beats = np.fromfile(base + '.beats.f32', dtype='<f4').reshape(-1, 3)
+            session = {name: samples[:, i] for i, name in enumerate(COLUMNS)}
+            session['file'] = summary['file']
+            session['beat_times'] = beats[:, 0]
+            session['beat_bpms'] = beats[:, 2]
+            sessions.append(session)
+    return sessions
+
+
+def load_session_pandas(csv_file):
+    """Load one CSV recording with pandas and compute the beat-based BPM series"""
+    import pandas as pd
+
+    # Check if first line contains numeric values (likely data) or text (likely headers)
+    with open(csv_file, 'r') as f:
+        first_line = f.readline().strip()
+        try:
+            float(first_line.split(',')[0])
+            has_headers = False
+        except ValueError:
+            has_headers = True
+
+    if has_headers:
+        df = pd.read_csv(csv_file)
+    else:
+        df = pd.read_csv(csv_file, header=None, names=COLUMNS)
+
+    time_offset = df['timestamp'].min()
+    session = {name: df[name].values for name in COLUMNS}
+    session['timestamp'] = session['timestamp'] - time_offset
+    session['file'] = csv_file
+
+    # BPM between consecutive beats with a sliding average of up to 10 values
+    beat_timestamps = session['timestamp'][session['beat_detected'] == 1]
+    beat_based_bpms = []
+    if len(beat_timestamps) > 1:
+        bpm_values = 60000.0 / np.diff(beat_timestamps)
+        for i in range(len(bpm_values)):
+            start_idx = max(0, i - 9)  # Include up to 10 previous values
+            beat_based_bpms.append(np.mean(bpm_values[start_idx:i+1]))
+    session['beat_times'] = beat_timestamps[1:len(beat_based_bpms)+1]  # Skip first beat, align with BPMs
+    session['beat_bpms'] = np.array(beat_based_bpms)
+    return session
+
+
+def plot_sensor_data(data_dir="data", show_beat_bpm=True, analysis_dir=None):
     """
     Plot timestamp vs signal data from CSV files in the data directory and save figures
 
     Args:
         data_dir (str): Directory containing CSV files (default: "data")
         show_beat_bpm (bool): Whether to show beat-based BPM calculation (default: True)
+        analysis_dir (str): Output of build/host/analyze for data_dir; the
+            recordings are then not parsed here at all (default: None)
     """
+    if analysis_dir:
+        sessions = load_sessions_analysis(analysis_dir)
+        if not sessions:
+            print(f"No sessions found in {analysis_dir}")
+            return
+        print(f"Found {len(sessions)} analyzed session(s)")
+        for i, session in enumerate(sessions):
+            plot_single_file(session, i, show_beat_bpm)
+        return
+
     # Get all CSV files in the data directory
     csv_files = glob.glob(os.path.join(data_dir, "*.csv"))
 
@@ -35,197 +110,102 @@ def plot_sensor_data(data_dir="data", show_beat_bpm=True):
     for file in csv_files:
         print(f"  - {os.path.basename(file)}")
 
-    # Check if this is measurements directory - create separate figures
-    is_measurements = "measurements" in data_dir
-
-    if is_measurements:
-        # Create separate figures for each measurement
-        for i, csv_file in enumerate(csv_files):
-            plot_single_file(csv_file, i, show_beat_bpm)
-    else:
-        # Create separate figures for examples as well
-        for i, csv_file in enumerate(csv_files):
-            plot_single_file(csv_file, i, show_beat_bpm)
+    # Create separate figures for each recording
+    for i, csv_file in enumerate(csv_files):
+        try:
+            session = load_session_pandas(csv_file)
+        except Exception as e:
+            print(f"Error processing data from {csv_file}: {e}")
+            continue
+        plot_single_file(session, i, show_beat_bpm)
 
 
-def plot_single_file(csv_file, index, show_beat_bpm=True):
-    """Plot a single CSV file with signal and BPM data in separate subplots"""
+def plot_single_file(session, index, show_beat_bpm=True):
+    """Plot a single session with signal and BPM data in separate subplots"""
     fig, (ax1, ax2) = plt.subplots(2, 1, figsize=(12, 10), sharex=True)
     
     # Plot signal data on top subplot
-    plot_signal_on_axis(csv_file, ax1)
+    plot_signal_on_axis(session, ax1)
     
     # Plot BPM data on bottom subplot
-    plot_bpm_on_axis(csv_file, ax2, show_beat_bpm)
+    plot_bpm_on_axis(session, ax2, show_beat_bpm)
     
     # Set overall title
-    fig.suptitle(f'Heartbeat Sensor Data - {os.path.basename(csv_file)}', fontsize=14)
+    fig.suptitle(f'Heartbeat Sensor Data - {os.path.basename(session["file"])}', fontsize=14)
     
     # Adjust layout
     plt.tight_layout()
     fig.subplots_adjust(top=0.92)
 
     # Save the figure next to the data file
-    csv_path = Path(csv_file)
-    output_path = csv_path.with_suffix('.png')
+    output_path = Path(session['file']).with_suffix('.png')
     fig.savefig(output_path, dpi=300, bbox_inches='tight')
     print(f"Saved figure to: {output_path}")
 
     plt.close(fig)  # Close the figure to free memory
 
 
-def plot_signal_on_axis(csv_file, ax):
+def plot_signal_on_axis(session, ax):
     """Plot signal data on the given axis"""
-    try:
-        # Read first few lines to check if file has headers
-        with open(csv_file, 'r') as f:
-            first_line = f.readline().strip()
-            # Check if first line contains numeric values (likely data) or text (likely headers)
-            try:
-                # If first value is numeric, assume no headers
-                float(first_line.split(',')[0])
-                has_headers = False
-            except ValueError:
-                # If first value is not numeric, assume headers
-                has_headers = True
-
-        if has_headers:
-            df = pd.read_csv(csv_file)
-            timestamp_col = 'timestamp'
-            signal_col = 'signal'
-            threshold_col = 'threshold'
-        else:
-            df = pd.read_csv(csv_file, header=None,
-                           names=['timestamp', 'signal', 'peak', 'trough', 'threshold', 'beat_detected', 'bpm'])
-            timestamp_col = 'timestamp'
-            signal_col = 'signal'
-            threshold_col = 'threshold'
-
-        # Plot the data
-        time_offset = df[timestamp_col].min()
-        ax.plot(df[timestamp_col] - time_offset, df[signal_col], 'b-', linewidth=1, alpha=0.8, label='Signal')
-        ax.set_ylabel('Signal Value')
-        ax.set_title('Signal Data')
-        ax.grid(True, alpha=0.3)
-
-        # Plot threshold if available
-        if threshold_col in df.columns:
-            ax.plot(df[timestamp_col] - time_offset, df[threshold_col], color='purple', linewidth=1.5,
-                   label='Threshold', alpha=0.8)
-
-        # Plot peak and trough if available
-        if 'peak' in df.columns:
-            ax.plot(df[timestamp_col] - time_offset, df['peak'], color='green', linewidth=1,
-                   label='Peak', alpha=0.8)
-        if 'trough' in df.columns:
-            ax.plot(df[timestamp_col] - time_offset, df['trough'], color='orange', linewidth=1,
-                   label='Trough', alpha=0.8)
-
-        # Plot beat detected markers
-        if 'beat_detected' in df.columns:
-            beats = df[df['beat_detected'] == 1]
-            if not beats.empty:
-                ax.scatter(beats[timestamp_col] - time_offset, beats[signal_col], color='red', s=30,
-                          label='Beats Detected', alpha=0.9)
-
-        ax.legend()
-
-    except Exception as e:
-        print(f"Error processing signal data from {csv_file}: {e}")
-
-
-def plot_bpm_on_axis(csv_file, ax, show_beat_bpm=True):
+    t = session['timestamp']
+    ax.plot(t, session['signal'], 'b-', linewidth=1, alpha=0.8, label='Signal')
+    ax.set_ylabel('Signal Value')
+    ax.set_title('Signal Data')
+    ax.grid(True, alpha=0.3)
+
+    ax.plot(t, session['threshold'], color='purple', linewidth=1.5, label='Threshold', alpha=0.8)
+    ax.plot(t, session['peak'], color='green', linewidth=1, label='Peak', alpha=0.8)
+    ax.plot(t, session['trough'], color='orange', linewidth=1, label='Trough', alpha=0.8)
+
+    # Plot beat detected markers
+    beats = session['beat_detected'] == 1
+    if beats.any():
+        ax.scatter(t[beats], session['signal'][beats], color='red', s=30,
+                   label='Beats Detected', alpha=0.9)
+
+    ax.legend()
+
+
+def plot_bpm_on_axis(session, ax, show_beat_bpm=True):
     """Plot BPM data on the given axis"""
-    try:
-        # Read first few lines to check if file has headers
-        with open(csv_file, 'r') as f:
-            first_line = f.readline().strip()
-            # Check if first line contains numeric values (likely data) or text (likely headers)
-            try:
-                # If first value is numeric, assume no headers
-                float(first_line.split(',')[0])
-                has_headers = False
-            except ValueError:
-                # If first value is not numeric, assume headers
-                has_headers = True
-
-        if has_headers:
-            df = pd.read_csv(csv_file)
-            timestamp_col = 'timestamp'
-            bpm_col = 'bpm'
-            beat_detected_col = 'beat_detected'
-        else:
-            df = pd.read_csv(csv_file, header=None,
-                           names=['timestamp', 'signal', 'peak', 'trough', 'threshold', 'beat_detected', 'bpm'])
-            timestamp_col = 'timestamp'
-            bpm_col = 'bpm'
-            beat_detected_col = 'beat_detected'
-
-        # Count total beats detected
-        total_beats = df[beat_detected_col].sum()
-
-        # Calculate average of sensor BPM values (no sliding average, just mean of all values)
-        valid_bpm_values = df[df[bpm_col] > 0][bpm_col]
-        if len(valid_bpm_values) > 0:
-            sensor_avg_bpm = valid_bpm_values.mean()
-        else:
-            sensor_avg_bpm = 0
-
-        # Calculate BPM from beat detections with sliding average of up to 10 values
-        beat_timestamps = df[df[beat_detected_col] == 1][timestamp_col].values
-        beat_based_bpms = []
-        
-        if len(beat_timestamps) > 1 and show_beat_bpm:
-            # Calculate BPM between consecutive beats
-            intervals_ms = np.diff(beat_timestamps)  # Time differences in milliseconds
-            intervals_sec = intervals_ms / 1000.0    # Convert to seconds
-            bpm_values = 60.0 / intervals_sec        # BPM = 60 / interval in seconds
-            
-            # Apply sliding average of up to 10 BPM values (never more)
-            for i in range(len(bpm_values)):
-                start_idx = max(0, i - 9)  # Include up to 10 previous values
-                avg_bpm = np.mean(bpm_values[start_idx:i+1])
-                beat_based_bpms.append(avg_bpm)
-            
-            # Create time array for beat-based BPMs (use beat timestamps)
-            beat_times = beat_timestamps[1:len(beat_based_bpms)+1]  # Skip first beat, align with BPMs
-        else:
-            beat_times = []
-            beat_based_bpms = []
-
-        # Plot BPM data from sensor
-        time_offset = df[timestamp_col].min()
-        ax.plot(df[timestamp_col] - time_offset, df[bpm_col], 'r-', linewidth=2, alpha=0.8, label='Sensor BPM')
-        
-        # Plot BPM calculated from beats
-        if len(beat_times) > 0 and len(beat_based_bpms) > 0:
-            ax.plot(beat_times - time_offset, beat_based_bpms, 'b--', linewidth=2, alpha=0.8, label='Beat-based BPM (smoothed)')
-        
-        ax.set_xlabel('Time (ms from start)')
-        ax.set_ylabel('BPM')
-        
-        # Update title with beat count and average BPM values
-        title = f'Heart Rate (BPM)\nBeats: {int(total_beats)}, Sensor Avg: {sensor_avg_bpm:.1f}'
-        if len(beat_based_bpms) > 0 and show_beat_bpm:
-            # Calculate average of the last 10 beat-based BPM values
-            last_beat_bpms = beat_based_bpms[-min(10, len(beat_based_bpms)):]
-            beat_avg_bpm = np.mean(last_beat_bpms)
-            title += f', Beat Avg: {beat_avg_bpm:.1f}'
-        ax.set_title(title)
-        
-        ax.grid(True, alpha=0.3)
-        ax.legend()
-
-        # Set Y limits for BPM starting from zero
-        valid_bpm = df[df[bpm_col] > 0][bpm_col]
-        if not valid_bpm.empty:
-            bpm_max = min(200, valid_bpm.max() + 10)
-            ax.set_ylim(bottom=0, top=bpm_max)
-        else:
-            ax.set_ylim(bottom=0, top=200)
-
-    except Exception as e:
-        print(f"Error processing BPM data from {csv_file}: {e}")
+    t = session['timestamp']
+    bpm = session['bpm']
+
+    # Count total beats detected
+    total_beats = int(session['beat_detected'].sum())
+
+    # Average of sensor BPM values (no sliding average, just mean of all values)
+    valid_bpm = bpm[bpm > 0]
+    sensor_avg_bpm = valid_bpm.mean() if len(valid_bpm) > 0 else 0
+
+    # Plot BPM data from sensor
+    ax.plot(t, bpm, 'r-', linewidth=2, alpha=0.8, label='Sensor BPM')
+
+    # Plot BPM calculated from beats
+    beat_times = session['beat_times']
+    beat_based_bpms = session['beat_bpms']
+    if show_beat_bpm and len(beat_based_bpms) > 0:
+        ax.plot(beat_times, beat_based_bpms, 'b--', linewidth=2, alpha=0.8, label='Beat-based BPM (smoothed)')
+
+    ax.set_xlabel('Time (ms from start)')
+    ax.set_ylabel('BPM')
+
+    # Update title with beat count and average BPM values
+    title = f'Heart Rate (BPM)\nBeats: {total_beats}, Sensor Avg: {sensor_avg_bpm:.1f}'
+    if show_beat_bpm and len(beat_based_bpms) > 0:
+        # Calculate average of the last 10 beat-based BPM values
+        beat_avg_bpm = np.mean(beat_based_bpms[-min(10, len(beat_based_bpms)):])
+        title += f', Beat Avg: {beat_avg_bpm:.1f}'
+    ax.set_title(title)
+
+    ax.grid(True, alpha=0.3)
+    ax.legend()
+
+    # Set Y limits for BPM starting from zero
+    if len(valid_bpm) > 0:
+        ax.set_ylim(bottom=0, top=min(200, valid_bpm.max() + 10))
+    else:
+        ax.set_ylim(bottom=0, top=200)
 
 def main():
     parser = argparse.ArgumentParser(description='Plot heartbeat sensor data from CSV files')
@@ -233,16 +213,18 @@ def main():
                        help='Directory containing CSV files (default: data)')
     parser.add_argument('--beat-bpm', action='store_true', 
                        help='Show beat-based BPM calculation (default: off)')
+    parser.add_argument('--analysis', metavar='DIR',
+                       help='Plot the output of build/host/analyze for data_dir instead of parsing the CSVs')
     
     args = parser.parse_args()
     
     # Check if data directory exists
     if not os.path.exists(args.data_dir):
         print(f"Error: Data directory '{args.data_dir}' not found!")
-        print("Usage: python plot_sensor_data.py [data_directory] [--beat-bpm]")
+        print("Usage: python plot_sensor_data.py [data_directory] [--beat-bpm] [--analysis DIR]")
         sys.exit(1)
 
-    plot_sensor_data(args.data_dir, args.beat_bpm)
+    plot_sensor_data(args.data_dir, args.beat_bpm, args.analysis)
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Source of timestamped raw ADC samples that Sensor drains in batches.
+// Implementations capture in the background (timer, DMA) and queue samples
+// lock-free; read() is called from the acquisition task only.
+class AcquisitionSource {
+public:
+    struct Sample {
+        uint32_t timestamp;  // Capture time in milliseconds (millis() clock)
+        uint16_t value;      // Raw 12-bit ADC reading
+    };
+
+    virtual ~AcquisitionSource() {}
+
+    virtual void init() = 0;
+    virtual void start() = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+
+    // Consumer side - copy up to maxSamples queued samples, returns count
+    virtual size_t read(Sample* out, size_t maxSamples) = 0;
+    virtual size_t getQueuedSamples() const = 0;
+    virtual uint32_t getDroppedSamples() const = 0;
+
+    // Output sample rate in Hz (takes effect on next start())
+    virtual int getSampleRate() const = 0;
+    virtual void setSampleRate(int rate) = 0;
+};
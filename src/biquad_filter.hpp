@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer-only IIR filtering for the sample path.
+//
+// Coefficients are designed at compile time (Butterworth sections via the
+// bilinear transform) and stored as Q28 fixed point; samples and filter
+// state are Q8. Each biquad costs five 32x32->64 bit multiply-accumulates.
+
+static const int BIQUAD_COEFF_BITS = 28;
+static const int BIQUAD_STATE_BITS = 8;
+
+struct BiquadCoefficients {
+    int32_t b0, b1, b2;  // Feed-forward
+    int32_t a1, a2;      // Feedback (a0 normalised to 1)
+};
+
+namespace biquad_design {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double BUTTERWORTH_Q = 0.70710678118654752440;
+
+// tan() for the small prewarp angles used here (pi * fc / fs < pi / 4)
+constexpr double tangent(double x) {
+    double sine = 0, cosine = 0;
+    double term = 1;
+    for (int n = 0; n < 24; n++) {
+        if (n % 2 == 0) {
+            cosine += (n % 4 == 0) ? term : -term;
+        } else {
+            sine += (n % 4 == 1) ? term : -term;
+        }
+        term *= x / (n + 1);
+    }
+    return sine / cosine;
+}
+
+constexpr int32_t toFixed(double value) {
+    return static_cast<int32_t>(value * (1L << BIQUAD_COEFF_BITS) + (value >= 0 ? 0.5 : -0.5));
+}
+
+}  // namespace biquad_design
+
+// Second-order Butterworth low-pass at cutoffHz
+constexpr BiquadCoefficients butterworthLowPass(double cutoffHz, double sampleRateHz) {
+    double k = biquad_design::tangent(biquad_design::PI * cutoffHz / sampleRateHz);
+    double norm = 1 / (1 + k / biquad_design::BUTTERWORTH_Q + k * k);
+    return BiquadCoefficients{
+        biquad_design::toFixed(k * k * norm),
+        biquad_design::toFixed(2 * k * k * norm),
+        biquad_design::toFixed(k * k * norm),
+        biquad_design::toFixed(2 * (k * k - 1) * norm),
+        biquad_design::toFixed((1 - k / biquad_design::BUTTERWORTH_Q + k * k) * norm)
+    };
+}
+
+// Second-order Butterworth high-pass at cutoffHz
+constexpr BiquadCoefficients butterworthHighPass(double cutoffHz, double sampleRateHz) {
+    double k = biquad_design::tangent(biquad_design::PI * cutoffHz / sampleRateHz);
+    double norm = 1 / (1 + k / biquad_design::BUTTERWORTH_Q + k * k);
+    return BiquadCoefficients{
+        biquad_design::toFixed(norm),
+        biquad_design::toFixed(-2 * norm),
+        biquad_design::toFixed(norm),
+        biquad_design::toFixed(2 * (k * k - 1) * norm),
+        biquad_design::toFixed((1 - k / biquad_design::BUTTERWORTH_Q + k * k) * norm)
+    };
+}
+
+// Cascade of Stages direct form I biquads
+template <size_t Stages>
+class BiquadCascade {
+private:
+    struct State {
+        int32_t x1, x2;  // Previous inputs (Q8)
+        int32_t y1, y2;  // Previous outputs (Q8)
+    };
+
+    BiquadCoefficients coefficients[Stages];
+    State state[Stages];
+
+public:
+    explicit BiquadCascade(const BiquadCoefficients (&stages)[Stages]) {
+        for (size_t i = 0; i < Stages; i++) {
+            coefficients[i] = stages[i];
+        }
+        prime(0);
+    }
+
+    // Load the steady-state response to a constant input, so switching the
+    // filter on mid-signal doesn't start with a large step transient
+    void prime(int input) {
+        int32_t x = input * (1 << BIQUAD_STATE_BITS);
+        for (size_t i = 0; i < Stages; i++) {
+            const BiquadCoefficients& c = coefficients[i];
+            int64_t dcNumerator = (int64_t)c.b0 + c.b1 + c.b2;
+            int64_t dcDenominator = (1LL << BIQUAD_COEFF_BITS) + c.a1 + c.a2;
+            int32_t y = static_cast<int32_t>(x * dcNumerator / dcDenominator);
+            state[i] = {x, x, y, y};
+            x = y;
+        }
+    }
+
+    // Filter one sample, returns the output in input units
+    int process(int input) {
+        int32_t x = input * (1 << BIQUAD_STATE_BITS);
+        for (size_t i = 0; i < Stages; i++) {
+            const BiquadCoefficients& c = coefficients[i];
+            State& s = state[i];
+            int64_t acc = (int64_t)c.b0 * x + (int64_t)c.b1 * s.x1 + (int64_t)c.b2 * s.x2
+                        - (int64_t)c.a1 * s.y1 - (int64_t)c.a2 * s.y2;
+            int32_t y = static_cast<int32_t>((acc + (1LL << (BIQUAD_COEFF_BITS - 1))) >> BIQUAD_COEFF_BITS);
+            s.x2 = s.x1;
+            s.x1 = x;
+            s.y2 = s.y1;
+            s.y1 = y;
+            x = y;
+        }
+        return (x + (1 << (BIQUAD_STATE_BITS - 1))) >> BIQUAD_STATE_BITS;
+    }
+
+    static constexpr size_t stages() { return Stages; }
+};
@@ -0,0 +1,170 @@
+#include "block_writer.hpp"
+#include "trace.hpp"
+
+BlockWriter::BlockWriter() :
+    activeBuffer(0),
+    activeLength(0),
+    pendingBuffer(1),
+    pendingLength(0),
+    flushPending(false),
+    finishing(false),
+    file(nullptr),
+    stats(),
+    debugOutput(false) {
+#ifdef ARDUINO_ARCH_ESP32
+  flushTaskHandle = nullptr;
+#endif
+}
+
+void BlockWriter::init() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (!flushTaskHandle) {
+    xTaskCreatePinnedToCore(flushTask, "flush", FLUSH_TASK_STACK_SIZE, this,
+                            FLUSH_TASK_PRIORITY, &flushTaskHandle, PRO_CPU_NUM);
+  }
+#endif
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void BlockWriter::flushTask(void* param) {
+  BlockWriter* writer = static_cast<BlockWriter*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    writer->flushPendingBlock();
+  }
+}
+#endif
+
+void BlockWriter::begin(File& target) {
+  file = &target;
+  activeBuffer = 0;
+  activeLength = 0;
+  finishing = false;
+  stats = Stats();
+}
+
+void BlockWriter::writeBlock(const uint8_t* data, size_t length) {
+  if (!file || !*file || length == 0) {
+    return;
+  }
+
+  TRACE_EVENT(FLUSH_BEGIN, length);
+  unsigned long started = micros();
+  file->write(data, length);
+  unsigned long elapsed = micros() - started;
+  TRACE_EVENT(FLUSH_END, length);
+
+  stats.blocksFlushed++;
+  stats.bytesWritten += length;
+  stats.lastFlushMicros = elapsed;
+  if (elapsed > stats.maxFlushMicros) {
+    stats.maxFlushMicros = elapsed;
+  }
+}
+
+void BlockWriter::flushPendingBlock() {
+  if (!flushPending.load(std::memory_order_acquire)) {
+    return;
+  }
+  writeBlock(buffers[pendingBuffer], pendingLength);
+  flushPending.store(false, std::memory_order_release);
+}
+
+bool BlockWriter::submitActiveBlock() {
+  if (flushPending.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  pendingBuffer = activeBuffer;
+  pendingLength = activeLength;
+  activeBuffer ^= 1;
+  activeLength = 0;
+  flushPending.store(true, std::memory_order_release);
+
+#ifdef ARDUINO_ARCH_ESP32
+  if (flushTaskHandle) {
+    xTaskNotifyGive(flushTaskHandle);
+    return true;
+  }
+#endif
+  // No background task (host builds) - flush inline
+  flushPendingBlock();
+  return true;
+}
+
+bool BlockWriter::write(const uint8_t* data, size_t length) {
+  if (!file || finishing) {
+    return false;
+  }
+
+  // Rows spill over into the next block so every flush is a whole block;
+  // if that block is still being written, drop the row instead of waiting
+  if (activeLength + length > BLOCK_SIZE && flushPending.load(std::memory_order_acquire)) {
+    stats.overruns++;
+    return false;
+  }
+
+  while (length > 0) {
+    size_t chunk = min(length, BLOCK_SIZE - activeLength);
+    memcpy(buffers[activeBuffer] + activeLength, data, chunk);
+    activeLength += chunk;
+    data += chunk;
+    length -= chunk;
+
+    if (activeLength == BLOCK_SIZE) {
+      submitActiveBlock();
+    }
+  }
+  return true;
+}
+
+void BlockWriter::finish() {
+  if (!file) {
+    return;
+  }
+  finishing = true;
+  isFinished();
+}
+
+bool BlockWriter::isFinished() {
+  if (!file) {
+    return true;
+  }
+  if (flushPending.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  // Hand the partial block to the flush path once it is free
+  if (activeLength > 0) {
+    submitActiveBlock();
+    if (flushPending.load(std::memory_order_acquire)) {
+      return false;
+    }
+  }
+
+  file = nullptr;
+  finishing = false;
+  if (debugOutput && Serial) {
+    Serial.printf("Block writer: %u blocks, %u bytes, %u overruns, max flush %u us\n",
+                  (unsigned)stats.blocksFlushed, (unsigned)stats.bytesWritten,
+                  (unsigned)stats.overruns, (unsigned)stats.maxFlushMicros);
+  }
+  return true;
+}
+
+bool BlockWriter::isFlushing() const {
+  return flushPending.load(std::memory_order_acquire);
+}
+
+const BlockWriter::Stats& BlockWriter::getStats() const {
+  return stats;
+}
+
+// Debug output control
+void BlockWriter::setDebugOutput(bool enable) {
+  debugOutput = enable;
+}
+
+bool BlockWriter::getDebugOutput() const {
+  return debugOutput;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+
+// Double-buffered block writer for recording files.
+// Rows are copied into a RAM block; full blocks are handed to a background
+// flush task and written to flash in one piece while the next block fills,
+// so a slow flash page program never stalls the caller. If both blocks are
+// busy the row is dropped and counted as an overrun.
+class BlockWriter {
+public:
+    static const size_t BLOCK_SIZE = 4096;  // SPIFFS-friendly, page aligned
+
+    struct Stats {
+        uint32_t blocksFlushed;
+        uint32_t bytesWritten;
+        uint32_t overruns;         // Rows dropped because both blocks were busy
+        uint32_t lastFlushMicros;
+        uint32_t maxFlushMicros;
+    };
+
+private:
+    uint8_t buffers[2][BLOCK_SIZE];
+    uint8_t activeBuffer;           // Block currently being filled
+    size_t activeLength;
+    uint8_t pendingBuffer;          // Block handed to the flush path
+    size_t pendingLength;
+    std::atomic<bool> flushPending;
+    bool finishing;                 // finish() requested, partial block not yet written
+    File* file;
+    Stats stats;
+    bool debugOutput;
+
+#ifdef ARDUINO_ARCH_ESP32
+    static const uint32_t FLUSH_TASK_STACK_SIZE = 4096;
+    static const UBaseType_t FLUSH_TASK_PRIORITY = 1;
+    TaskHandle_t flushTaskHandle;
+    static void flushTask(void* param);
+#endif
+
+    void writeBlock(const uint8_t* data, size_t length);
+    void flushPendingBlock();
+    bool submitActiveBlock();
+
+public:
+    BlockWriter();
+    void init();  // Start the background flush task
+
+    void begin(File& target);  // Start buffering writes to an open file
+    bool write(const uint8_t* data, size_t length);  // false if the data was dropped
+    void finish();       // Queue the partial block, returns without waiting
+    bool isFinished();   // Poll after finish(); true once everything is on flash
+
+    bool isFlushing() const;
+    const Stats& getStats() const;
+
+    // Debug output control
+    void setDebugOutput(bool enable);
+    bool getDebugOutput() const;
+};
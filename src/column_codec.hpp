@@ -0,0 +1,242 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "record_format.hpp"
+
+// Compressed columnar recording format shared by DataLogger and the host tools.
+//
+// Samples are buffered into blocks and every SampleRecord field is stored as
+// its own column of zigzag varints, so slowly changing columns (peak/trough
+// decay, constant threshold and BPM, fixed timestamp step) shrink to about a
+// byte per sample or less. Blocks are independent: a lost block loses only
+// its own samples.
+//
+// File layout, multi-byte fields little-endian:
+//   header:  "HBC" 0x00 | version u8 | column count u8 | max block samples u16
+//   block:   sample count u16 | payload size u16 | payload
+//   payload: per column, in SampleRecord order
+//            (timestamp, signal, peak, trough, threshold, flags, bpm):
+//            encoding u8 | sample count zigzag varints
+//
+// Column encodings are bit flags picked per block and column, whichever is
+// smallest: COLUMN_DELTA2 stores the change of the delta instead of the
+// delta (timestamps), COLUMN_ZERO_RUNS follows every zero with a varint
+// count of further zeros (constant columns). Both start from 0 at the
+// beginning of each block.
+
+static const uint8_t COLUMN_FORMAT_VERSION = 1;
+static const size_t COLUMN_HEADER_SIZE = 8;
+static const size_t COLUMN_BLOCK_HEADER_SIZE = 4;
+static const size_t COLUMN_COUNT = 7;
+static const size_t COLUMN_BLOCK_SAMPLES = 128;
+static const uint8_t COLUMN_DELTA2 = 0x01;
+static const uint8_t COLUMN_ZERO_RUNS = 0x02;
+
+// Largest varint per sample of each column (u32 timestamp, 16-bit fields, u8 flags)
+static const size_t COLUMN_MAX_SAMPLE_BYTES = 5 + 3 + 3 + 3 + 3 + 2 + 3;
+static const size_t COLUMN_BLOCK_MAX_SIZE =
+    COLUMN_BLOCK_HEADER_SIZE + COLUMN_COUNT + COLUMN_BLOCK_SAMPLES * COLUMN_MAX_SAMPLE_BYTES;
+
+inline void encodeColumnHeader(uint8_t* out) {
+    memcpy(out, "HBC", 4);  // Includes the terminating zero
+    out[4] = COLUMN_FORMAT_VERSION;
+    out[5] = COLUMN_COUNT;
+    writeLE16(out + 6, COLUMN_BLOCK_SAMPLES);
+}
+
+// Returns false if the header isn't a version this code can read
+inline bool decodeColumnHeader(const uint8_t* in) {
+    return memcmp(in, "HBC", 4) == 0 && in[4] == COLUMN_FORMAT_VERSION && in[5] == COLUMN_COUNT &&
+           readLE16(in + 6) <= COLUMN_BLOCK_SAMPLES;
+}
+
+inline uint32_t zigzagEncode(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t zigzagDecode(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+inline size_t varintSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+inline size_t writeVarint(uint8_t* out, uint32_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (uint8_t)value;
+    return size;
+}
+
+// Returns bytes consumed, 0 if the varint runs past end or is too long
+inline size_t readVarint(const uint8_t* in, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (size_t i = 0; i < 5 && in + i < end; i++) {
+        value |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Field of a record as an unsigned column value; signed fields wrap, so
+// deltas are plain uint32 differences
+inline uint32_t recordColumn(const SampleRecord& record, size_t column) {
+    switch (column) {
+        case 0: return record.timestamp;
+        case 1: return (uint32_t)(int32_t)record.signal;
+        case 2: return (uint32_t)(int32_t)record.peak;
+        case 3: return (uint32_t)(int32_t)record.trough;
+        case 4: return (uint32_t)(int32_t)record.threshold;
+        case 5: return record.flags;
+        default: return record.bpm;
+    }
+}
+
+inline void setRecordColumn(SampleRecord& record, size_t column, uint32_t value) {
+    switch (column) {
+        case 0: record.timestamp = value; break;
+        case 1: record.signal = (int16_t)value; break;
+        case 2: record.peak = (int16_t)value; break;
+        case 3: record.trough = (int16_t)value; break;
+        case 4: record.threshold = (int16_t)value; break;
+        case 5: record.flags = (uint8_t)value; break;
+        default: record.bpm = (uint16_t)value; break;
+    }
+}
+
+// Zigzagged delta (or delta of delta) stream of one column
+inline void columnSymbols(const SampleRecord* records, size_t count, size_t column, bool delta2, uint32_t* out) {
+    uint32_t previous = 0;
+    uint32_t previousDelta = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value = recordColumn(records[i], column);
+        uint32_t delta = value - previous;
+        out[i] = zigzagEncode((int32_t)(delta2 ? delta - previousDelta : delta));
+        previous = value;
+        previousDelta = delta;
+    }
+}
+
+inline size_t symbolsSize(const uint32_t* symbols, size_t count, bool zeroRuns) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        size += varintSize(symbols[i]);
+        if (zeroRuns && symbols[i] == 0) {
+            size_t run = 0;
+            while (i + 1 < count && symbols[i + 1] == 0) {
+                run++;
+                i++;
+            }
+            size += varintSize(run);
+        }
+    }
+    return size;
+}
+
+inline size_t writeSymbols(const uint32_t* symbols, size_t count, bool zeroRuns, uint8_t* out) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; i++) {
+        size += writeVarint(out + size, symbols[i]);
+        if (zeroRuns && symbols[i] == 0) {
+            size_t run = 0;
+            while (i + 1 < count && symbols[i + 1] == 0) {
+                run++;
+                i++;
+            }
+            size += writeVarint(out + size, run);
+        }
+    }
+    return size;
+}
+
+// Encode up to COLUMN_BLOCK_SAMPLES records as one block (header included)
+// into out, which must hold COLUMN_BLOCK_MAX_SIZE bytes; returns its size
+inline size_t encodeColumnBlock(const SampleRecord* records, size_t count, uint8_t* out) {
+    uint32_t delta[COLUMN_BLOCK_SAMPLES];
+    uint32_t delta2[COLUMN_BLOCK_SAMPLES];
+    size_t size = COLUMN_BLOCK_HEADER_SIZE;
+    for (size_t column = 0; column < COLUMN_COUNT; column++) {
+        columnSymbols(records, count, column, false, delta);
+        columnSymbols(records, count, column, true, delta2);
+
+        // Smallest of the four encodings, the simpler one on a tie
+        uint8_t best = 0;
+        size_t bestSize = symbolsSize(delta, count, false);
+        for (uint8_t encoding = 1; encoding < 4; encoding++) {
+            size_t encodingSize = symbolsSize((encoding & COLUMN_DELTA2) ? delta2 : delta, count,
+                                              (encoding & COLUMN_ZERO_RUNS) != 0);
+            if (encodingSize < bestSize) {
+                best = encoding;
+                bestSize = encodingSize;
+            }
+        }
+
+        out[size++] = best;
+        size += writeSymbols((best & COLUMN_DELTA2) ? delta2 : delta, count, (best & COLUMN_ZERO_RUNS) != 0, out + size);
+    }
+    writeLE16(out, count);
+    writeLE16(out + 2, size - COLUMN_BLOCK_HEADER_SIZE);
+    return size;
+}
+
+// Decode a block payload of count samples into records; false if malformed
+inline bool decodeColumnBlock(const uint8_t* payload, size_t size, size_t count, SampleRecord* records) {
+    if (count > COLUMN_BLOCK_SAMPLES) {
+        return false;
+    }
+    const uint8_t* in = payload;
+    const uint8_t* end = payload + size;
+    for (size_t column = 0; column < COLUMN_COUNT; column++) {
+        if (in >= end || *in > (COLUMN_DELTA2 | COLUMN_ZERO_RUNS)) {
+            return false;
+        }
+        uint8_t encoding = *in++;
+        uint32_t previous = 0;
+        uint32_t previousDelta = 0;
+        uint32_t zerosLeft = 0;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t symbol = 0;
+            if (zerosLeft > 0) {
+                zerosLeft--;
+            } else {
+                size_t used = readVarint(in, end, symbol);
+                if (!used) {
+                    return false;
+                }
+                in += used;
+                if ((encoding & COLUMN_ZERO_RUNS) && symbol == 0) {
+                    used = readVarint(in, end, zerosLeft);
+                    if (!used) {
+                        return false;
+                    }
+                    in += used;
+                }
+            }
+
+            uint32_t delta = (uint32_t)zigzagDecode(symbol);
+            if (encoding & COLUMN_DELTA2) {
+                delta += previousDelta;
+            }
+            previous += delta;
+            previousDelta = delta;
+            setRecordColumn(records[i], column, previous);
+        }
+        if (zerosLeft > 0) {
+            return false;
+        }
+    }
+    return in == end;
+}
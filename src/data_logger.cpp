@@ -1,11 +1,27 @@
 #include "data_logger.hpp"
+#include "trace.hpp"
 #include <SPIFFS.h>
 
 DataLogger::DataLogger() :
     recordingEnabled(false),
+    recordingFormat(RecordingFormat::CSV),
+    debugOutput(false),
     autoRecordingTime(DEFAULT_AUTO_RECORDING_TIME),
     recordingStartTime(0),
-    debugOutput(false) {
+    blockRecordCount(0),
+    dumpRecordIndex(0),
+    dumpState(DumpState::IDLE),
+    dumpCancelled(false),
+    startPending(false),
+    dumpFormat(DUMP_FORMAT_CSV),
+    dumpBytesTotal(0),
+    dumpBytesDone(0),
+    dumpMode(DumpMode::TEXT),
+    dumpSeq(0),
+    dumpCrc(0),
+    dumpAckWaitStart(0),
+    dumpEndSentTime(0),
+    resendCount(0) {
 }
 
 void DataLogger::init() {
@@ -19,12 +35,29 @@ void DataLogger::init() {
       Serial.println("SPIFFS initialized successfully");
     }
   }
+
+  blockWriter.init();
 }
 
 void DataLogger::startRecording(const char* filename) {
+  // A new recording replaces the file that may still be dumping. If the
+  // last recording is still draining to flash, serviceDump() starts the new
+  // one once the block writer is done instead of waiting here.
+  if (isDumping()) {
+    abortDump();
+  }
+  if (dumpState == DumpState::CLOSING) {
+    startPending = true;
+    pendingFilename = filename ? filename : "";
+    return;
+  }
+
+  if (!filename) {
+    filename = getDefaultFilename();
+  }
   recordingFilename = filename;
 
-  // Delete existing file and create new one with CSV header
+  // Delete existing file and create new one with CSV header or binary file header
   if (SPIFFS.exists(filename)) {
     SPIFFS.remove(filename);
     if (debugOutput && Serial) {
@@ -35,7 +68,21 @@ void DataLogger::startRecording(const char* filename) {
   // Open file once and keep it open for the entire recording session
   recordingFile = SPIFFS.open(filename, FILE_WRITE);
   if (recordingFile) {
-    recordingFile.println("timestamp,signal,peak,trough,threshold,beat_detected,bpm");
+    blockWriter.setDebugOutput(debugOutput);
+    blockWriter.begin(recordingFile);
+    blockRecordCount = 0;
+    if (recordingFormat == RecordingFormat::BINARY) {
+      uint8_t header[RECORD_HEADER_SIZE];
+      encodeRecordHeader(header);
+      blockWriter.write(header, sizeof(header));
+    } else if (recordingFormat == RecordingFormat::COMPRESSED) {
+      uint8_t header[COLUMN_HEADER_SIZE];
+      encodeColumnHeader(header);
+      blockWriter.write(header, sizeof(header));
+    } else {
+      const char header[] = RECORD_CSV_HEADER "\r\n";
+      blockWriter.write(reinterpret_cast<const uint8_t*>(header), sizeof(header) - 1);
+    }
     recordingEnabled = true;
     recordingStartTime = millis();
 
@@ -53,11 +100,18 @@ void DataLogger::startRecording(const char* filename) {
 }
 
 void DataLogger::stopRecording() {
+  // Stopped before it could start, there is nothing new to dump
+  if (startPending) {
+    startPending = false;
+    return;
+  }
   recordingEnabled = false;
 
-  // Close the recording file
+  // Queue buffered rows for flash; the file is closed by serviceDump()
+  // once the block writer is done, so this returns immediately
   if (recordingFile) {
-    recordingFile.close();
+    flushCompressedBlock();
+    blockWriter.finish();
   }
 
   if (debugOutput && Serial) {
@@ -66,14 +120,62 @@ void DataLogger::stopRecording() {
   }
 
   // Automatically dump recorded data when stopping
-  dumpRecordedData();
+  dumpState = DumpState::CLOSING;
+  dumpBytesTotal = 0;
+  dumpBytesDone = 0;
 }
 
 bool DataLogger::isRecording() const {
-  return recordingEnabled;
+  return recordingEnabled || startPending;
 }
 
 void DataLogger::dumpRecordedData() {
+  if (isRecording() || isDumping()) {
+    return;
+  }
+  dumpState = DumpState::CLOSING;
+  dumpBytesTotal = 0;
+  dumpBytesDone = 0;
+}
+
+void DataLogger::serviceDump() {
+  switch (dumpState) {
+    case DumpState::CLOSING:
+      if (!blockWriter.isFinished()) {
+        return;
+      }
+      if (recordingFile) {
+        recordingFile.close();
+      }
+      if (dumpCancelled || startPending) {
+        dumpCancelled = false;
+        dumpState = DumpState::IDLE;
+        if (startPending) {
+          startPending = false;
+          startRecording(pendingFilename.length() ? pendingFilename.c_str() : nullptr);
+        }
+        return;
+      }
+      beginDumpStream();
+      break;
+    case DumpState::STREAMING:
+      if (dumpMode == DumpMode::FRAMED) {
+        streamFramedChunk();
+      } else {
+        streamTextChunk();
+      }
+      break;
+    case DumpState::AWAITING_ACK:
+      serviceDumpAck();
+      break;
+    default:
+      break;
+  }
+}
+
+void DataLogger::beginDumpStream() {
+  dumpState = DumpState::IDLE;
+
   if (!recordingFilename.length()) {
     if (debugOutput && Serial) {
       Serial.println("ERROR: No recording filename set");
@@ -81,8 +183,8 @@ void DataLogger::dumpRecordedData() {
     return;
   }
 
-  File file = SPIFFS.open(recordingFilename.c_str(), FILE_READ);
-  if (!file) {
+  dumpFile = SPIFFS.open(recordingFilename.c_str(), FILE_READ);
+  if (!dumpFile) {
     if (debugOutput && Serial) {
       Serial.print("ERROR: Failed to open file for reading: ");
       Serial.println(recordingFilename);
@@ -90,25 +192,260 @@ void DataLogger::dumpRecordedData() {
     return;
   }
 
-  // Always output data markers for auto-save script compatibility
-  if (Serial) {
+  // Binary and compressed recordings are identified by their header
+  uint8_t header[RECORD_HEADER_SIZE > COLUMN_HEADER_SIZE ? RECORD_HEADER_SIZE : COLUMN_HEADER_SIZE];
+  size_t headerRead = dumpFile.read(header, sizeof(header));
+  size_t headerSize = 0;  // File header skipped by TEXT dumps
+  dumpFormat = DUMP_FORMAT_CSV;
+  if (headerRead >= RECORD_HEADER_SIZE && decodeRecordHeader(header)) {
+    dumpFormat = DUMP_FORMAT_BINARY;
+    headerSize = RECORD_HEADER_SIZE;
+  } else if (headerRead >= COLUMN_HEADER_SIZE && decodeColumnHeader(header)) {
+    dumpFormat = DUMP_FORMAT_COMPRESSED;
+    headerSize = COLUMN_HEADER_SIZE;
+  }
+  dumpBytesTotal = dumpFile.size();
+  dumpBytesDone = 0;
+  blockRecordCount = 0;
+  dumpRecordIndex = 0;
+  dumpSeq = 0;
+  dumpCrc = 0;
+  resendCount = 0;
+  dumpFile.seek(0);
+
+  if (dumpMode == DumpMode::FRAMED) {
+    // The file is sent as is, the host converts binary and compressed recordings
+    uint8_t payload[7];
+    payload[0] = dumpFormat;
+    writeLE32(payload + 1, dumpBytesTotal);
+    writeLE16(payload + 5, getDumpFrameCount());
+    sendFrame(FRAME_DUMP_START, 0, payload, sizeof(payload));
+  } else if (Serial) {
+    // Always output data markers for auto-save script compatibility;
+    // binary and compressed recordings are converted back to CSV on the fly
     Serial.println("===DATA_START===");
+    if (dumpFormat != DUMP_FORMAT_CSV) {
+      Serial.println(RECORD_CSV_HEADER);
+      dumpFile.seek(headerSize);
+      dumpBytesDone = headerSize;
+    }
+  }
+  dumpState = DumpState::STREAMING;
+}
+
+void DataLogger::streamTextChunk() {
+  // Only send what fits in the UART TX buffer so Serial never blocks
+  size_t budget = min((size_t)Serial.availableForWrite(), DUMP_CHUNK_SIZE);
+
+  if (dumpFormat == DUMP_FORMAT_COMPRESSED) {
+    char line[64];
+    while (dumpRecordIndex < blockRecordCount || readCompressedBlock()) {
+      // Longest CSV row plus line ending
+      if (budget < 48) {
+        return;
+      }
+      int length = formatRecordCsv(blockRecords[dumpRecordIndex++], line, sizeof(line) - 2);
+      line[length++] = '\r';
+      line[length++] = '\n';
+      Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+      budget -= length;
+    }
+  } else if (dumpFormat == DUMP_FORMAT_BINARY) {
+    uint8_t raw[RECORD_SIZE];
+    char line[64];
+    SampleRecord record;
+    while (dumpFile.available() >= (int)RECORD_SIZE) {
+      // Longest CSV row plus line ending
+      if (budget < 48) {
+        return;
+      }
+      dumpFile.read(raw, sizeof(raw));
+      decodeRecord(raw, record);
+      int length = formatRecordCsv(record, line, sizeof(line) - 2);
+      line[length++] = '\r';
+      line[length++] = '\n';
+      Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+      budget -= length;
+      dumpBytesDone += RECORD_SIZE;
+    }
+  } else {
+    // CSV files are already in the wire format - copy them through as is
+    uint8_t chunk[256];
+    while (dumpFile.available() > 0) {
+      if (budget == 0) {
+        return;
+      }
+      size_t count = dumpFile.read(chunk, min(budget, sizeof(chunk)));
+      Serial.write(chunk, count);
+      budget -= count;
+      dumpBytesDone += count;
+    }
   }
 
-  while (file.available()) {
-    String line = file.readStringUntil('\n');
-    // Always output data lines for auto-save script compatibility
-    if (Serial) {
-      Serial.println(line);
+  endDumpStream("===DATA_END===");
+}
+
+// Load the next block of a compressed recording for the TEXT dump; false at
+// the end of the file or on a damaged block
+bool DataLogger::readCompressedBlock() {
+  blockRecordCount = 0;
+  dumpRecordIndex = 0;
+
+  uint8_t header[COLUMN_BLOCK_HEADER_SIZE];
+  if (dumpFile.read(header, sizeof(header)) != sizeof(header)) {
+    return false;
+  }
+  size_t count = readLE16(header);
+  size_t size = readLE16(header + 2);
+  if (size > sizeof(encodedBlock) || dumpFile.read(encodedBlock, size) != size ||
+      !decodeColumnBlock(encodedBlock, size, count, blockRecords)) {
+    if (debugOutput && Serial) {
+      Serial.println("ERROR: Damaged compressed block, dump truncated");
+    }
+    return false;
+  }
+  blockRecordCount = count;
+  dumpBytesDone += sizeof(header) + size;
+  return count > 0;
+}
+
+void DataLogger::streamFramedChunk() {
+  size_t sent = 0;
+  uint16_t frameCount = getDumpFrameCount();
+  while (sent < DUMP_CHUNK_SIZE && Serial.availableForWrite() >= (int)FRAME_MAX_SIZE) {
+    if (resendCount > 0) {
+      sent += sendDataFrame(resendQueue[--resendCount], false);
+    } else if (dumpSeq < frameCount) {
+      sent += sendDataFrame(dumpSeq++, true);
+    } else {
+      sendDumpEnd();
+      dumpState = DumpState::AWAITING_ACK;
+      dumpAckWaitStart = millis();
+      return;
     }
   }
+}
+
+size_t DataLogger::sendDataFrame(uint16_t seq, bool sequential) {
+  uint8_t payload[FRAME_MAX_PAYLOAD];
+  dumpFile.seek((uint32_t)seq * FRAME_MAX_PAYLOAD);
+  size_t length = dumpFile.read(payload, sizeof(payload));
+
+  // The whole-file CRC is accumulated on the first, in-order pass only
+  if (sequential) {
+    dumpCrc = crc32Update(dumpCrc, payload, length);
+    dumpBytesDone += length;
+  }
+  TRACE_EVENT(DUMP_CHUNK, seq);
+  return sendFrame(FRAME_DUMP_DATA, seq, payload, length);
+}
 
-  file.close();
+void DataLogger::sendDumpEnd() {
+  uint8_t payload[11];
+  payload[0] = dumpFormat;
+  writeLE32(payload + 1, dumpBytesTotal);
+  writeLE16(payload + 5, getDumpFrameCount());
+  writeLE32(payload + 7, dumpCrc);
+  sendFrame(FRAME_DUMP_END, getDumpFrameCount(), payload, sizeof(payload));
+  dumpEndSentTime = millis();
+}
+
+size_t DataLogger::sendFrame(uint8_t type, uint16_t seq, const uint8_t* payload, size_t length) {
+  size_t frameSize = encodeFrame(type, seq, payload, length, frameBuffer);
+  if (Serial) {
+    Serial.write(frameBuffer, frameSize);
+  }
+  return frameSize;
+}
+
+void DataLogger::serviceDumpAck() {
+  // Serve retransmission requests until the host acknowledges the dump
+  while (resendCount > 0 && Serial.availableForWrite() >= (int)FRAME_MAX_SIZE) {
+    sendDataFrame(resendQueue[--resendCount], false);
+  }
+
+  unsigned long now = millis();
+  if (now - dumpAckWaitStart > DUMP_ACK_TIMEOUT_MS) {
+    if (debugOutput && Serial) {
+      Serial.println("Dump not acknowledged, giving up");
+    }
+    dumpFile.close();
+    dumpState = DumpState::IDLE;
+  } else if (resendCount == 0 && now - dumpEndSentTime > DUMP_END_REPEAT_MS) {
+    // The END frame itself may have been lost
+    sendDumpEnd();
+  }
+}
+
+void DataLogger::requestResend(uint16_t seq) {
+  if (dumpMode != DumpMode::FRAMED || dumpState == DumpState::IDLE || seq >= getDumpFrameCount()) {
+    return;
+  }
+  for (uint8_t i = 0; i < resendCount; i++) {
+    if (resendQueue[i] == seq) {
+      return;
+    }
+  }
+  if (resendCount < RESEND_QUEUE_SIZE) {
+    resendQueue[resendCount++] = seq;
+  }
+  // Host is still working on it
+  dumpAckWaitStart = millis();
+}
+
+void DataLogger::acknowledgeDump() {
+  if (dumpState == DumpState::AWAITING_ACK) {
+    dumpFile.close();
+    dumpState = DumpState::IDLE;
+  }
+}
+
+uint16_t DataLogger::getDumpFrameCount() const {
+  return (dumpBytesTotal + FRAME_MAX_PAYLOAD - 1) / FRAME_MAX_PAYLOAD;
+}
+
+void DataLogger::endDumpStream(const char* marker) {
+  dumpFile.close();
+  dumpState = DumpState::IDLE;
 
   // Always output data end marker for auto-save script compatibility
   if (Serial) {
-    Serial.println("===DATA_END===");
+    Serial.println(marker);
+  }
+}
+
+void DataLogger::abortDump() {
+  if (dumpState == DumpState::STREAMING || dumpState == DumpState::AWAITING_ACK) {
+    if (dumpMode == DumpMode::FRAMED) {
+      // Host notices the missing END frame and discards the partial dump
+      dumpFile.close();
+      dumpState = DumpState::IDLE;
+    } else {
+      endDumpStream("===DATA_ABORT===");
+    }
+  } else if (dumpState == DumpState::CLOSING) {
+    // The recording file can only be closed once the block writer has
+    // drained; serviceDump() does that without starting the dump
+    if (blockWriter.isFinished()) {
+      if (recordingFile) {
+        recordingFile.close();
+      }
+      dumpState = DumpState::IDLE;
+    } else {
+      dumpCancelled = true;
+    }
+  }
+}
+
+bool DataLogger::isDumping() const {
+  return dumpState != DumpState::IDLE;
+}
+
+int DataLogger::getDumpProgress() const {
+  if (dumpBytesTotal == 0) {
+    return 0;
   }
+  return (int)((uint64_t)dumpBytesDone * 100 / dumpBytesTotal);
 }
 
 void DataLogger::logData(unsigned long timestamp, int signal, int peak, int trough,
@@ -117,20 +454,78 @@ void DataLogger::logData(unsigned long timestamp, int signal, int peak, int trou
     return;
   }
 
-  // Write data to the already open file
-  recordingFile.print(timestamp);
-  recordingFile.print(",");
-  recordingFile.print(signal);
-  recordingFile.print(",");
-  recordingFile.print(peak);
-  recordingFile.print(",");
-  recordingFile.print(trough);
-  recordingFile.print(",");
-  recordingFile.print(threshold);
-  recordingFile.print(",");
-  recordingFile.print(beatDetected ? "1" : "0");
-  recordingFile.print(",");
-  recordingFile.println(bpm);
+  SampleRecord record;
+  record.timestamp = timestamp;
+  record.signal = signal;
+  record.peak = peak;
+  record.trough = trough;
+  record.threshold = threshold;
+  record.flags = beatDetected ? RECORD_FLAG_BEAT : 0;
+  record.bpm = max(0, bpm);
+
+  // Columns are encoded a whole block at a time
+  if (recordingFormat == RecordingFormat::COMPRESSED) {
+    blockRecords[blockRecordCount++] = record;
+    if (blockRecordCount == COLUMN_BLOCK_SAMPLES) {
+      flushCompressedBlock();
+    }
+    return;
+  }
+
+  // Encode the row and append it to the current flash block
+  uint8_t row[64];
+  size_t length;
+  if (recordingFormat == RecordingFormat::BINARY) {
+    encodeRecord(record, row);
+    length = RECORD_SIZE;
+  } else {
+    length = formatRecordCsv(record, reinterpret_cast<char*>(row), sizeof(row) - 2);
+    row[length++] = '\r';
+    row[length++] = '\n';
+  }
+  blockWriter.write(row, length);
+}
+
+// Encode the buffered samples as one block; a dropped block loses only its own samples
+void DataLogger::flushCompressedBlock() {
+  if (blockRecordCount == 0) {
+    return;
+  }
+  size_t size = encodeColumnBlock(blockRecords, blockRecordCount, encodedBlock);
+  blockWriter.write(encodedBlock, size);
+  blockRecordCount = 0;
+}
+
+// Recording format configuration
+void DataLogger::setRecordingFormat(RecordingFormat format) {
+  recordingFormat = format;
+}
+
+DataLogger::RecordingFormat DataLogger::getRecordingFormat() const {
+  return recordingFormat;
+}
+
+const char* DataLogger::getDefaultFilename() const {
+  switch (recordingFormat) {
+    case RecordingFormat::BINARY: return "/sensor_data.bin";
+    case RecordingFormat::COMPRESSED: return "/sensor_data.hbc";
+    default: return "/sensor_data.csv";
+  }
+}
+
+// Dump mode configuration
+void DataLogger::setDumpMode(DumpMode mode) {
+  if (!isDumping()) {
+    dumpMode = mode;
+  }
+}
+
+DataLogger::DumpMode DataLogger::getDumpMode() const {
+  return dumpMode;
+}
+
+const BlockWriter::Stats& DataLogger::getWriterStats() const {
+  return blockWriter.getStats();
 }
 
 // Autorecording configuration
@@ -147,7 +542,7 @@ unsigned long DataLogger::getRecordingStartTime() const {
 }
 
 void DataLogger::checkAutoStop() {
-  if (isRecording() && getAutoRecordingTime() > 0) {
+  if (recordingEnabled && getAutoRecordingTime() > 0) {
     unsigned long elapsed = millis() - recordingStartTime;
     if (elapsed >= (unsigned long)getAutoRecordingTime() * 1000) {
       stopRecording();
@@ -2,16 +2,93 @@
 
 #include <Arduino.h>
 #include <SPIFFS.h>
+#include "block_writer.hpp"
+#include "column_codec.hpp"
+#include "frame_codec.hpp"
+#include "record_format.hpp"
 
 class DataLogger {
+public:
+    // On-flash recording format - BINARY appends fixed-width records
+    // (see record_format.hpp), COMPRESSED buffers samples into delta/varint
+    // encoded column blocks (see column_codec.hpp), dumps are converted back to CSV
+    enum class RecordingFormat : int {
+        CSV = 0,
+        BINARY,
+        COMPRESSED
+    };
+
+    // Serial dump protocol - TEXT sends CSV lines between ===DATA_START===
+    // and ===DATA_END=== markers, FRAMED sends the raw file in CRC32-checked
+    // frames (see frame_codec.hpp) with retransmission on request
+    enum class DumpMode : int {
+        TEXT = 0,
+        FRAMED
+    };
+
 private:
+    // Incremental dump state - the dump is streamed a bounded chunk per
+    // serviceDump() call so stopping a recording never blocks the caller
+    enum class DumpState : int {
+        IDLE = 0,
+        CLOSING,      // Waiting for the block writer to put the tail on flash
+        STREAMING,    // Sending file contents over Serial
+        AWAITING_ACK  // FRAMED: all frames sent, serving resend requests
+    };
+
     bool recordingEnabled;
+    RecordingFormat recordingFormat;
     String recordingFilename;
     File recordingFile;  // Keep file handle open during recording
+    BlockWriter blockWriter;  // Buffers rows into whole-block flash writes
     bool debugOutput;    // Debug output control
     int autoRecordingTime;  // Autorecording duration in seconds
     unsigned long recordingStartTime;  // Timestamp when recording started
 
+    // COMPRESSED: samples of the block being filled while recording, the
+    // block being sent during a TEXT dump
+    SampleRecord blockRecords[COLUMN_BLOCK_SAMPLES];
+    size_t blockRecordCount;
+    size_t dumpRecordIndex;
+    uint8_t encodedBlock[COLUMN_BLOCK_MAX_SIZE];
+
+    void flushCompressedBlock();
+    bool readCompressedBlock();
+
+    DumpState dumpState;
+    bool dumpCancelled;    // CLOSING: close the file without dumping it
+    bool startPending;     // CLOSING: startRecording() waits for the block writer to drain
+    String pendingFilename;
+    File dumpFile;
+    uint8_t dumpFormat;    // DUMP_FORMAT_* of the file, TEXT dumps convert non-CSV files on the fly
+    size_t dumpBytesTotal;
+    size_t dumpBytesDone;
+
+    // Framed dump state
+    DumpMode dumpMode;
+    uint16_t dumpSeq;           // Next data frame of the in-order pass
+    uint32_t dumpCrc;           // CRC32 of the file bytes sent so far
+    unsigned long dumpAckWaitStart;
+    unsigned long dumpEndSentTime;
+    static const uint8_t RESEND_QUEUE_SIZE = 16;
+    uint16_t resendQueue[RESEND_QUEUE_SIZE];
+    uint8_t resendCount;
+    uint8_t frameBuffer[FRAME_MAX_SIZE];
+
+    static const size_t DUMP_CHUNK_SIZE = 2048;  // Max Serial bytes per serviceDump() call
+    static const unsigned long DUMP_ACK_TIMEOUT_MS = 10000;
+    static const unsigned long DUMP_END_REPEAT_MS = 1000;
+
+    void beginDumpStream();
+    void streamTextChunk();
+    void streamFramedChunk();
+    void serviceDumpAck();
+    size_t sendDataFrame(uint16_t seq, bool sequential);
+    void sendDumpEnd();
+    size_t sendFrame(uint8_t type, uint16_t seq, const uint8_t* payload, size_t length);
+    uint16_t getDumpFrameCount() const;
+    void endDumpStream(const char* marker);
+
     // Configuration defaults and limits
     static const int DEFAULT_AUTO_RECORDING_TIME = 30;
     static const int AUTO_RECORDING_MIN = 0;
@@ -22,15 +99,37 @@ public:
     void init();
 
     // Data recording control
-    void startRecording(const char* filename = "/sensor_data.csv");
+    void startRecording(const char* filename = nullptr);  // nullptr picks the format's default file
     void stopRecording();
     bool isRecording() const;
-    void dumpRecordedData();
+
+    // Recorded data dump over Serial (non-blocking, driven by serviceDump())
+    void dumpRecordedData();  // Start dumping the last recording
+    void serviceDump();       // Call every loop/tick to make progress
+    void abortDump();
+    bool isDumping() const;
+    int  getDumpProgress() const;  // Percent of the file sent so far
+
+    // Host replies in FRAMED mode
+    void requestResend(uint16_t seq);  // Host reported frame seq missing/corrupt
+    void acknowledgeDump();            // Host has the complete file
+
+    // Dump mode configuration (ignored while a dump is in progress)
+    void setDumpMode(DumpMode mode);
+    DumpMode getDumpMode() const;
 
     // Data logging - called from sensor with data
     void logData(unsigned long timestamp, int signal, int peak, int trough,
                  int threshold, bool beatDetected, int bpm);
 
+    // Recording format configuration (takes effect on next startRecording())
+    void setRecordingFormat(RecordingFormat format);
+    RecordingFormat getRecordingFormat() const;
+    const char* getDefaultFilename() const;
+
+    // Flash writer statistics of the current/last recording
+    const BlockWriter::Stats& getWriterStats() const;
+
     // Autorecording configuration
     void setAutoRecordingTime(int time);
     int getAutoRecordingTime() const;
@@ -1,14 +1,20 @@
 #include "display.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
 
 Display::Display(Sensor& sensorRef, DataLogger& loggerRef) : 
-    display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET),
     currentSelection(MenuOption::DATA_RECORDING),
+    display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, DISPLAY_I2C_CLOCK),
     sensor(sensorRef),
     dataLogger(loggerRef),
     debugOutput(false),
-    signalHistoryIndex(0) {
-  // Initialize signal history with zeros
-  memset(signalHistory, 0, sizeof(signalHistory));
+    graphWindow(DEFAULT_GRAPH_WINDOW),
+    renderStats(),
+    fpsWindowStart(0),
+    fpsWindowFrames(0),
+    renderCacheEnabled(true),
+    renderCacheReady(false) {
+  clearSignalHistory();
 }
 
 void Display::init() {
@@ -21,131 +27,372 @@ void Display::init() {
   
   // Set default text color
   display.setTextColor(SSD1306_WHITE);
+  buildRenderCache();
   display.clearDisplay();
   display.display();
 }
 
-void Display::updateSignalHistory(int signalValue) {
-  signalHistory[signalHistoryIndex] = signalValue;
-  signalHistoryIndex = (signalHistoryIndex + 1) % SIGNAL_HISTORY_SIZE;
+void Display::buildRenderCache() {
+  // Digit glyphs: render each once at the top-left corner and read back its columns
+  static const char glyphChars[BIG_GLYPH_COUNT + 1] = "0123456789-";
+  const uint8_t* buffer = display.getBuffer();
+  for (int g = 0; g < BIG_GLYPH_COUNT; g++) {
+    display.clearDisplay();
+    display.drawChar(0, 0, glyphChars[g], SSD1306_WHITE, SSD1306_WHITE, BIG_TEXT_SIZE);
+    for (int x = 0; x < BIG_GLYPH_WIDTH; x++) {
+      bigGlyphs[g][x] = buffer[x] | (buffer[SCREEN_WIDTH + x] << 8) | ((uint32_t)buffer[2 * SCREEN_WIDTH + x] << 16);
+    }
+  }
+
+  // Static layers
+  for (int screen = 0; screen < SCREEN_COUNT; screen++) {
+    display.clearDisplay();
+    drawStaticContent(static_cast<DisplaySnapshot::Screen>(screen));
+    memcpy(staticLayers[screen], display.getBuffer(), FRAME_BYTES);
+  }
+  renderCacheReady = true;
 }
 
-void Display::showBPM(int bpm) {
-  display.clearDisplay();
-  
-  // Title
+void Display::beginFrame(DisplaySnapshot::Screen screen) {
+  if (renderCacheEnabled && renderCacheReady) {
+    memcpy(display.getBuffer(), staticLayers[static_cast<int>(screen)], FRAME_BYTES);
+  } else {
+    display.clearDisplay();
+    drawStaticContent(screen);
+  }
+}
+
+// Text that never changes on a screen - everything else is drawn per frame
+void Display::drawStaticContent(DisplaySnapshot::Screen screen) {
   display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println(F("Heart Rate Monitor"));
+  switch (screen) {
+    case DisplaySnapshot::Screen::BPM:
+      display.setCursor(0, 0);
+      display.println(F("Heart Rate Monitor"));
+      display.setCursor(100, 40);
+      display.println(F("BPM"));
+      break;
+    case DisplaySnapshot::Screen::SIGNAL_GRAPH:
+      display.setCursor(0, 0);
+      display.println(F("Heart Signal Graph"));
+      display.setCursor(0, 56);
+      display.print(F("Signal: "));
+      break;
+    case DisplaySnapshot::Screen::MENU:
+      display.setCursor(0, 0);
+      display.println(F("Settings"));
+      display.setCursor(110, 0);
+      display.print(F("BPM"));
+      // Captions start after the 2-character selection prefix
+      display.setCursor(12, 20);
+      display.print(F("Recording:"));
+      display.setCursor(12, 32);
+      display.print(F("Auto record:"));
+      display.setCursor(12, 44);
+      display.print(F("Thrs offset:"));
+      display.setCursor(12, 56);
+      display.print(F("Decay rate:"));
+      break;
+  }
+}
+
+void Display::drawBigText(int x, int y, const char* text) {
+  if (!renderCacheEnabled || !renderCacheReady) {
+    display.setTextSize(BIG_TEXT_SIZE);
+    display.setCursor(x, y);
+    display.print(text);
+    return;
+  }
+
+  // OR the cached glyph columns into the pages they straddle
+  uint8_t* buffer = display.getBuffer();
+  for (; *text; text++, x += BIG_GLYPH_WIDTH) {
+    int glyph;
+    if (*text >= '0' && *text <= '9') {
+      glyph = *text - '0';
+    } else if (*text == '-') {
+      glyph = 10;
+    } else {
+      continue;  // Space
+    }
+    for (int column = 0; column < BIG_GLYPH_WIDTH; column++) {
+      int px = x + column;
+      if (px < 0 || px >= SCREEN_WIDTH) {
+        continue;
+      }
+      uint64_t bits = (uint64_t)bigGlyphs[glyph][column] << (y & 7);
+      for (int page = y / 8; bits && page < SCREEN_HEIGHT / 8; page++, bits >>= 8) {
+        buffer[page * SCREEN_WIDTH + px] |= bits & 0xFF;
+      }
+    }
+  }
+}
+
+void Display::setRenderCache(bool enable) {
+  renderCacheEnabled = enable;
+}
+
+bool Display::getRenderCache() const {
+  return renderCacheEnabled;
+}
+
+void Display::clearSignalHistory() {
+  currentColumn = 0;
+  columnsFilled = 0;
+  closedLows.clear();
+  closedHighs.clear();
+}
+
+void Display::updateSignalHistory(int signalValue, unsigned long timestamp) {
+  updateSignalHistory(signalValue, signalValue, timestamp);
+}
+
+void Display::updateSignalHistory(int low, int high, unsigned long timestamp) {
+  uint32_t column = (uint64_t)timestamp * GRAPH_COLUMNS / (graphWindow * 1000UL);
+
+  if (columnsFilled == 0) {
+    currentColumn = column;
+    columnLow[column % GRAPH_COLUMNS] = low;
+    columnHigh[column % GRAPH_COLUMNS] = high;
+    columnsFilled = 1;
+    return;
+  }
+
+  if (column > currentColumn) {
+    // Close the open column; columns without samples hold its last level
+    int index = currentColumn % GRAPH_COLUMNS;
+    int hold = columnHigh[index];
+    closedLows.push(columnLow[index]);
+    closedHighs.push(columnHigh[index]);
+    columnsFilled = (int)min((uint32_t)columnsFilled + (column - currentColumn), (uint32_t)GRAPH_COLUMNS);
+
+    // After a long gap only the last screen width of columns matters
+    if (column - currentColumn > (uint32_t)GRAPH_COLUMNS) {
+      currentColumn = column - GRAPH_COLUMNS;
+    }
+    for (currentColumn++; currentColumn < column; currentColumn++) {
+      index = currentColumn % GRAPH_COLUMNS;
+      columnLow[index] = hold;
+      columnHigh[index] = hold;
+      closedLows.push(hold);
+      closedHighs.push(hold);
+    }
+    columnLow[column % GRAPH_COLUMNS] = low;
+    columnHigh[column % GRAPH_COLUMNS] = high;
+    return;
+  }
+
+  // Same column (or a late sample) - widen the open bin
+  int index = currentColumn % GRAPH_COLUMNS;
+  columnLow[index] = min((int)columnLow[index], low);
+  columnHigh[index] = max((int)columnHigh[index], high);
+}
+
+int Display::getGraphWindow() const {
+  return graphWindow;
+}
+
+void Display::setGraphWindow(int seconds) {
+  int window = max(GRAPH_WINDOW_MIN, min(GRAPH_WINDOW_MAX, seconds));
+  if (window != graphWindow) {
+    // Column width changes, existing bins can't be reused
+    graphWindow = window;
+    clearSignalHistory();
+  }
+}
+
+void Display::handleGraphZoomIn() {
+  setGraphWindow(graphWindow - graphWindowStep);
+}
+
+void Display::handleGraphZoomOut() {
+  setGraphWindow(graphWindow + graphWindowStep);
+}
+
+void Display::capture(DisplaySnapshot& snapshot, DisplaySnapshot::Screen screen, int bpm) {
+  snapshot.screen = screen;
+  snapshot.timestamp = millis();
+  snapshot.bpm = bpm;
+  snapshot.signal = sensor.getSignal();
+
+  // Envelope columns, oldest first
+  snapshot.graphColumns = columnsFilled;
+  snapshot.graphWindow = graphWindow;
+  for (int i = 0; i < columnsFilled; i++) {
+    int index = (currentColumn - columnsFilled + 1 + i) % GRAPH_COLUMNS;
+    snapshot.graphLow[i] = columnLow[index];
+    snapshot.graphHigh[i] = columnHigh[index];
+  }
+  if (columnsFilled > 0) {
+    int openIndex = currentColumn % GRAPH_COLUMNS;
+    snapshot.graphMin = closedLows.empty() ? columnLow[openIndex] : min(closedLows.min(), (int)columnLow[openIndex]);
+    snapshot.graphMax = closedHighs.empty() ? columnHigh[openIndex] : max(closedHighs.max(), (int)columnHigh[openIndex]);
+  } else {
+    snapshot.graphMin = 0;
+    snapshot.graphMax = 0;
+  }
+
+  snapshot.menuSelection = static_cast<uint8_t>(currentSelection);
+  snapshot.recording = dataLogger.isRecording();
+  snapshot.dumping = dataLogger.isDumping();
+  snapshot.dumpProgress = snapshot.dumping ? dataLogger.getDumpProgress() : 0;
+  snapshot.autoRecordingTime = dataLogger.getAutoRecordingTime();
+  snapshot.thresholdOffset = sensor.getThresholdOffset();
+  snapshot.decayRate = sensor.getDecayRate();
+}
+
+void Display::publishSnapshot(DisplaySnapshot::Screen screen, int bpm) {
+  capture(snapshots.writeSlot(), screen, bpm);
+  if (!snapshots.publish()) {
+    renderStats.droppedFrames++;
+  }
+}
+
+bool Display::renderLatest() {
+  if (!snapshots.take()) {
+    return false;
+  }
+  render(snapshots.readSlot());
+  return true;
+}
+
+void Display::render(const DisplaySnapshot& snapshot) {
+  {
+    PROFILE_SCOPE(DISPLAY_RENDER);
+    TRACE_SCOPE(DISPLAY_RENDER);
+    draw(snapshot);
+  }
+
+  // Wait only if the previous frame is still on the bus
+  while (!display.present()) {
+    delay(1);
+  }
+
+  renderStats.framesRendered++;
+  fpsWindowFrames++;
+  uint32_t elapsed = snapshot.timestamp - fpsWindowStart;
+  if (elapsed >= 1000) {
+    renderStats.framesPerSecond = fpsWindowFrames * 1000 / elapsed;
+    fpsWindowStart = snapshot.timestamp;
+    fpsWindowFrames = 0;
+  }
+}
+
+void Display::draw(const DisplaySnapshot& snapshot) {
+  switch (snapshot.screen) {
+    case DisplaySnapshot::Screen::BPM:
+      drawBPM(snapshot);
+      break;
+    case DisplaySnapshot::Screen::SIGNAL_GRAPH:
+      drawSignalGraph(snapshot);
+      break;
+    case DisplaySnapshot::Screen::MENU:
+      drawMenu(snapshot);
+      break;
+  }
+}
+
+const Display::RenderStats& Display::getRenderStats() const {
+  return renderStats;
+}
+
+void Display::showBPM(int bpm) {
+  capture(immediateSnapshot, DisplaySnapshot::Screen::BPM, bpm);
+  render(immediateSnapshot);
+}
+
+void Display::showSignalGraph() {
+  capture(immediateSnapshot, DisplaySnapshot::Screen::SIGNAL_GRAPH, 0);
+  render(immediateSnapshot);
+}
+
+void Display::showMenu(int bpm) {
+  capture(immediateSnapshot, DisplaySnapshot::Screen::MENU, bpm);
+  render(immediateSnapshot);
+}
+
+void Display::drawBPM(const DisplaySnapshot& snapshot) {
+  beginFrame(DisplaySnapshot::Screen::BPM);
   
   // BPM value on the left
-  display.setTextSize(3);
-  display.setCursor(10, 25);
-  if (bpm > 0) {
-    char bpmStr[4];
-    sprintf(bpmStr, "%3d", bpm);
-    display.print(bpmStr);
+  if (snapshot.bpm > 0) {
+    char bpmStr[12];
+    snprintf(bpmStr, sizeof(bpmStr), "%3d", snapshot.bpm);
+    drawBigText(10, 25, bpmStr);
   } else {
-    display.print(" --");
+    drawBigText(10, 25, " --");
   }
   
-  // BPM label on the right
-  display.setTextSize(1);
-  display.setCursor(100, 40);
-  display.println(F("BPM"));
-  
   // Flashing recording indicator in top right corner
-  drawRecordingIndicator();
-  
-  display.display();
+  drawRecordingIndicator(snapshot);
+  drawDumpProgress(snapshot);
 }
 
-void Display::showSignalGraph() {
-  display.clearDisplay();
-  
-  // Title
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println(F("Heart Signal Graph"));
+void Display::drawSignalGraph(const DisplaySnapshot& snapshot) {
+  beginFrame(DisplaySnapshot::Screen::SIGNAL_GRAPH);
   
   // Draw the signal graph
   int graphHeight = 32;  // Reduced to leave space for signal value at bottom
   int graphY = 20;
-  int graphWidth = 128;  // Full screen width
+  int graphWidth = DisplaySnapshot::GRAPH_WIDTH;  // Full screen width
   
-  // Find min and max values in the signal history for scaling
-  int minVal = 1023;
-  int maxVal = 0;
-  for (int i = 0; i < SIGNAL_HISTORY_SIZE; i++) {
-    if (signalHistory[i] < minVal) minVal = signalHistory[i];
-    if (signalHistory[i] > maxVal) maxVal = signalHistory[i];
-  }
+  // Autoscale to the range of the visible window (full 12-bit ADC range)
+  int minVal = snapshot.graphMin;
+  int maxVal = snapshot.graphMax;
   
   // Avoid division by zero
   if (maxVal == minVal) {
     maxVal = minVal + 1;
   }
   
-  // Draw the graph
-  for (int x = 0; x < graphWidth; x++) {
-    // Calculate history index: x=0 is oldest, x=127 is newest
-    int historyIndex = (signalHistoryIndex - graphWidth + x + SIGNAL_HISTORY_SIZE) % SIGNAL_HISTORY_SIZE;
-    int signalValue = signalHistory[historyIndex];
+  // Draw the envelope, newest column at the right edge
+  int firstX = graphWidth - snapshot.graphColumns;
+  for (int i = 0; i < snapshot.graphColumns; i++) {
+    // Scale the signal range to fit in the graph height
+    int yTop = graphY + graphHeight - ((snapshot.graphHigh[i] - minVal) * graphHeight / (maxVal - minVal));
+    int yBottom = graphY + graphHeight - ((snapshot.graphLow[i] - minVal) * graphHeight / (maxVal - minVal));
     
-    // Scale the signal value to fit in the graph height
-    int y = graphY + graphHeight - ((signalValue - minVal) * graphHeight / (maxVal - minVal));
-    
-    // Draw a point
-    display.drawPixel(x, y, SSD1306_WHITE);
+    // Vertical line covering everything the column's samples reached
+    display.drawFastVLine(firstX + i, yTop, yBottom - yTop + 1, SSD1306_WHITE);
   }
   
-  // Display current signal value at bottom
-  int currentSignal = sensor.getSignal();
-  
+  // Display current signal value at bottom, after the "Signal: " label
   display.setTextSize(1);
-  display.setCursor(0, 56);
-  display.print(F("Signal: "));
-  display.print(currentSignal);
+  display.setCursor(48, 56);
+  display.print(snapshot.signal);
+  display.setCursor(104, 56);
+  display.printf("%2ds", snapshot.graphWindow);
   
   // Flashing recording indicator in top right corner
-  drawRecordingIndicator();
-  
-  display.display();
+  drawRecordingIndicator(snapshot);
+  drawDumpProgress(snapshot);
 }
 
-void Display::showMenu() {
-  display.clearDisplay();
-  
-  // Menu title
-  display.setTextSize(1);
-  display.setCursor(0, 0);
-  display.println(F("Settings"));
+void Display::drawMenu(const DisplaySnapshot& snapshot) {
+  beginFrame(DisplaySnapshot::Screen::MENU);
   
   // Show BPM in top right corner
-  int currentBPM = sensor.getBPM();
+  display.setTextSize(1);
   display.setCursor(80, 0);
-  if (currentBPM > 0) {
-    display.printf("%3d", currentBPM);
+  if (snapshot.bpm > 0) {
+    display.printf("%3d", snapshot.bpm);
   } else {
     display.print(" --");
   }
-  display.setCursor(110, 0);
-  display.print(F("BPM"));
 
-  // Menu options with values
-  display.setTextSize(1);
+  // Selection marker in front of the current option's caption
+  display.setCursor(0, 20 + 12 * snapshot.menuSelection);
+  display.print('>');
+
+  // Menu option values
   
   // Data recording option (first item)
-  display.setCursor(0, 20);
-  display.printf("%sRecording:", getPrefix(MenuOption::DATA_RECORDING));
   display.setCursor(100, 20);
-  display.printf("%4s", dataLogger.isRecording() ? "ON" : "OFF");
+  display.printf("%4s", snapshot.recording ? "ON" : "OFF");
   
   // Autorecording option
-  display.setCursor(0, 32);
-  display.printf("%sAuto record:", getPrefix(MenuOption::AUTORECORDING));
   display.setCursor(100, 32);
-  int recTime = dataLogger.getAutoRecordingTime();
+  int recTime = snapshot.autoRecordingTime;
   if (recTime == 0) {
     display.printf("%4s", "NO");
   } else {
@@ -153,18 +400,14 @@ void Display::showMenu() {
   }
   
   // Threshold option
-  display.setCursor(0, 44);
-  display.printf("%sThrs offset:", getPrefix(MenuOption::BEAT_THRESHOLD));
   display.setCursor(100, 44);
-  display.printf("%4d", sensor.getThresholdOffset());
+  display.printf("%4d", snapshot.thresholdOffset);
   
   // Decay rate option
-  display.setCursor(0, 56);
-  display.printf("%sDecay rate:", getPrefix(MenuOption::DECAY_RATE));
   display.setCursor(100, 56);
-  display.printf("%4d", sensor.getDecayRate());
+  display.printf("%4d", snapshot.decayRate);
 
-  display.display();
+  drawDumpProgress(snapshot);
 }
 
 void Display::handleUpMovement() {
@@ -188,7 +431,7 @@ void Display::handleLeftMovement() {
       if (dataLogger.isRecording()) {
         dataLogger.stopRecording();
       } else {
-        dataLogger.startRecording("/sensor_data.csv");
+        dataLogger.startRecording();
       }
       break;
     }
@@ -219,7 +462,7 @@ void Display::handleRightMovement() {
       if (dataLogger.isRecording()) {
         dataLogger.stopRecording();
       } else {
-        dataLogger.startRecording("/sensor_data.csv");
+        dataLogger.startRecording();
       }
       break;
     }
@@ -243,20 +486,37 @@ void Display::handleRightMovement() {
   }
 }
 
-const char* Display::getPrefix(MenuOption option) const {
-  return (currentSelection == option) ? "> " : "  ";
-}
-
 // Helper method for recording indicator
-void Display::drawRecordingIndicator() {
-  if (dataLogger.isRecording()) {
-    unsigned long currentMillis = millis();
-    if ((currentMillis / 500) % 2 == 0) {
+void Display::drawRecordingIndicator(const DisplaySnapshot& snapshot) {
+  if (snapshot.recording) {
+    if ((snapshot.timestamp / 500) % 2 == 0) {
       display.fillCircle(120, 5, 2, SSD1306_WHITE);
     }
   }
 }
 
+// Helper method for dump progress bar
+void Display::drawDumpProgress(const DisplaySnapshot& snapshot) {
+  // Thin bar under the title line while a recording is sent over Serial
+  if (snapshot.dumping) {
+    display.drawRect(0, 9, SCREEN_WIDTH, 3, SSD1306_WHITE);
+    display.fillRect(0, 9, SCREEN_WIDTH * snapshot.dumpProgress / 100, 3, SSD1306_WHITE);
+  }
+}
+
+// I2C transfer configuration and statistics
+void Display::setI2CClock(uint32_t frequency) {
+  display.setI2CClock(frequency);
+}
+
+uint32_t Display::getI2CClock() const {
+  return display.getI2CClock();
+}
+
+const PartialSSD1306::FrameStats& Display::getFrameStats() const {
+  return display.getFrameStats();
+}
+
 // Debug output control
 void Display::setDebugOutput(bool enable) {
   debugOutput = enable;
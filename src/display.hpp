@@ -3,10 +3,55 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include "partial_ssd1306.hpp"
+#include "sliding_min_max.hpp"
+#include "snapshot_mailbox.hpp"
 #include "sensor.hpp"
 #include "data_logger.hpp"
 
+// SSD1306 I2C clock in Hz during transfers (400000, or 1000000 for modules that handle it)
+#ifndef DISPLAY_I2C_CLOCK
+#define DISPLAY_I2C_CLOCK 400000
+#endif
+
+// Everything a frame shows, captured on the control side so rendering
+// never touches Sensor/DataLogger state from another task
+struct DisplaySnapshot {
+    enum class Screen : uint8_t {
+        BPM,
+        SIGNAL_GRAPH,
+        MENU
+    };
+
+    static const int GRAPH_WIDTH = 128;  // One min/max bin per pixel column
+
+    Screen   screen;
+    uint32_t timestamp;          // millis() at capture, drives blinking
+    int      bpm;
+    int      signal;
+    int16_t  graphLow[GRAPH_WIDTH];   // Per-column signal envelope, oldest first
+    int16_t  graphHigh[GRAPH_WIDTH];
+    uint8_t  graphColumns;            // Columns filled so far (right-aligned)
+    int16_t  graphMin;                // Autoscale range of the envelope
+    int16_t  graphMax;
+    uint8_t  graphWindow;             // Seconds covered by GRAPH_WIDTH columns
+    uint8_t  menuSelection;
+    bool     recording;
+    bool     dumping;
+    uint8_t  dumpProgress;       // Percent
+    int      autoRecordingTime;
+    int      thresholdOffset;
+    int      decayRate;
+};
+
 class Display {
+public:
+    struct RenderStats {
+        uint32_t framesRendered;
+        uint32_t droppedFrames;    // Snapshots replaced before they were rendered
+        uint32_t framesPerSecond;  // Measured over the last second
+    };
+
 private:
     enum class MenuOption : int {
         DATA_RECORDING = 0,
@@ -22,41 +67,115 @@ private:
     static const int OLED_RESET = -1;
 
     MenuOption currentSelection;
-    Adafruit_SSD1306 display;
+    PartialSSD1306 display;
     Sensor& sensor;
     DataLogger& dataLogger;
     bool debugOutput;  // Debug output control
     
-    // Signal graph data
-    static const int SIGNAL_HISTORY_SIZE = 128;  // Number of signal points to display
-    int signalHistory[SIGNAL_HISTORY_SIZE];
-    int signalHistoryIndex;
-    
+    // Signal graph: min/max envelope decimated into one bin per pixel column,
+    // so RAM depends on the screen width, not on window length or sample rate
+    static const int GRAPH_COLUMNS = DisplaySnapshot::GRAPH_WIDTH;
+    static const int DEFAULT_GRAPH_WINDOW = 4;  // Seconds
+    static const int GRAPH_WINDOW_MIN = 2;
+    static const int GRAPH_WINDOW_MAX = 10;
+    int graphWindow;
+    int16_t columnLow[GRAPH_COLUMNS];   // Ring of bins, newest at currentColumn
+    int16_t columnHigh[GRAPH_COLUMNS];
+    uint32_t currentColumn;             // Absolute column number (timestamp / column width)
+    int columnsFilled;
+    // Autoscale over the closed columns; the open one is merged in at capture
+    SlidingMinMax<int, GRAPH_COLUMNS - 1> closedLows;
+    SlidingMinMax<int, GRAPH_COLUMNS - 1> closedHighs;
+
+    void clearSignalHistory();
+
     static const int offsetStep = 5;
     static const int thresholdStep = 5;
     static const int decayStep = 1;
     static const int recordingStep = 5;
+    static const int graphWindowStep = 2;
+
+    // Snapshot hand-over to the render task and frame rate measurement
+    SnapshotMailbox<DisplaySnapshot> snapshots;
+    DisplaySnapshot immediateSnapshot;  // For the synchronous show*() calls
+    RenderStats renderStats;
+    uint32_t fpsWindowStart;
+    uint32_t fpsWindowFrames;
+
+    // Render cache: each screen's constant text pre-rendered once and copied
+    // into the framebuffer, plus column bitmaps of the size-3 BPM digits
+    static const int SCREEN_COUNT = 3;
+    static const int FRAME_BYTES = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+    static const int BIG_TEXT_SIZE = 3;
+    static const int BIG_GLYPH_WIDTH = 6 * BIG_TEXT_SIZE;  // Font cell incl. spacing
+    static const int BIG_GLYPH_COUNT = 11;                 // 0-9 and '-'
+    uint8_t staticLayers[SCREEN_COUNT][FRAME_BYTES];
+    uint32_t bigGlyphs[BIG_GLYPH_COUNT][BIG_GLYPH_WIDTH];  // Bit 0 = top row
+    bool renderCacheEnabled;
+    bool renderCacheReady;
+
+    void buildRenderCache();
+    void beginFrame(DisplaySnapshot::Screen screen);
+    void drawStaticContent(DisplaySnapshot::Screen screen);
+    void drawBigText(int x, int y, const char* text);
+
+    void drawBPM(const DisplaySnapshot& snapshot);
+    void drawSignalGraph(const DisplaySnapshot& snapshot);
+    void drawMenu(const DisplaySnapshot& snapshot);
 
-    // Helper method for menu display
-    const char* getPrefix(MenuOption option) const;
-    
     // Helper method for recording indicator
-    void drawRecordingIndicator();
+    void drawRecordingIndicator(const DisplaySnapshot& snapshot);
+
+    // Helper method for dump progress bar
+    void drawDumpProgress(const DisplaySnapshot& snapshot);
 
 public:
     Display(Sensor& sensorRef, DataLogger& loggerRef);
     void init();
-    void updateSignalHistory(int signalValue);
+    // Add samples to the graph envelope (timestamp in ms)
+    void updateSignalHistory(int signalValue, unsigned long timestamp);
+    void updateSignalHistory(int low, int high, unsigned long timestamp);
+
+    // Graph time window in seconds
+    int  getGraphWindow() const;
+    void setGraphWindow(int seconds);
+    static int getGraphWindowMin() { return GRAPH_WINDOW_MIN; }
+    static int getGraphWindowMax() { return GRAPH_WINDOW_MAX; }
+    void handleGraphZoomIn();   // Shorter window
+    void handleGraphZoomOut();  // Longer window
+
+    // Pipelined rendering: the control task publishes snapshots, the render
+    // task draws the newest one (returns false if there was none)
+    void publishSnapshot(DisplaySnapshot::Screen screen, int bpm);
+    bool renderLatest();
+    void render(const DisplaySnapshot& snapshot);
+    const RenderStats& getRenderStats() const;
+
+    // Pipeline steps, public for benchmarks: fill a snapshot from the current
+    // state, and draw one into the back buffer without presenting it
+    void capture(DisplaySnapshot& snapshot, DisplaySnapshot::Screen screen, int bpm);
+    void draw(const DisplaySnapshot& snapshot);
+
+    // Cached static layers and digit glyphs (on by default)
+    void setRenderCache(bool enable);
+    bool getRenderCache() const;
+
+    // Synchronous capture + render, for single-threaded callers
     void showBPM(int bpm);
     void showSignalGraph();
 
     // Menu display and navigation methods
-    void showMenu();
+    void showMenu(int bpm);
     void handleUpMovement();
     void handleDownMovement();
     void handleLeftMovement();   // Decrease current setting value
     void handleRightMovement();  // Increase current setting value
 
+    // I2C transfer configuration and statistics
+    void setI2CClock(uint32_t frequency);
+    uint32_t getI2CClock() const;
+    const PartialSSD1306::FrameStats& getFrameStats() const;
+
     // Debug output control
     void setDebugOutput(bool enable);
     bool getDebugOutput() const;
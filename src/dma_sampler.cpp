@@ -0,0 +1,142 @@
+#include "dma_sampler.hpp"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <driver/adc.h>
+#endif
+
+DmaSampler::DmaSampler(int pin) :
+    inputPin(pin),
+    overflows(0) {
+#ifdef ARDUINO_ARCH_ESP32
+  readerTaskHandle = nullptr;
+  readerActive = false;
+  stopRequested = false;
+#endif
+}
+
+void DmaSampler::init() {
+  pinMode(inputPin, INPUT);
+}
+
+void DmaSampler::start() {
+  if (running) {
+    stop();
+  }
+
+#ifdef ARDUINO_ARCH_ESP32
+  int8_t channel = digitalPinToAnalogChannel(inputPin);
+  if (channel < 0 || channel >= ADC1_CHANNEL_MAX) {
+    if (debugOutput && Serial) {
+      Serial.println("DMA sampler: pin is not on ADC1!");
+    }
+    return;
+  }
+
+  // The controller can't convert slower than 20 kHz, raise the oversampling to match
+  uint32_t minimumFactor = (CONVERSION_RATE_MIN + sampleRate - 1) / sampleRate;
+  setOversampling(max((uint32_t)oversampling, minimumFactor));
+  uint32_t conversionRate = min(getConversionRate(), CONVERSION_RATE_MAX);
+
+  adc_digi_init_config_t initConfig = {};
+  initConfig.max_store_buf_size = 4 * FRAME_CONVERSIONS * CONVERSION_BYTES;
+  initConfig.conv_num_each_intr = FRAME_CONVERSIONS * CONVERSION_BYTES;
+  initConfig.adc1_chan_mask = BIT(channel);
+  initConfig.adc2_chan_mask = 0;
+
+  adc_digi_pattern_config_t pattern = {};
+  pattern.atten = ADC_ATTEN_DB_11;
+  pattern.channel = channel;
+  pattern.unit = 0;  // ADC1
+  pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+  adc_digi_configuration_t config = {};
+  config.conv_limit_en = true;  // Required on the ESP32
+  config.conv_limit_num = 250;
+  config.pattern_num = 1;
+  config.adc_pattern = &pattern;
+  config.sample_freq_hz = conversionRate;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+  if (adc_digi_initialize(&initConfig) != ESP_OK || adc_digi_controller_configure(&config) != ESP_OK) {
+    adc_digi_deinitialize();
+    if (debugOutput && Serial) {
+      Serial.println("DMA sampler: ADC configuration failed!");
+    }
+    return;
+  }
+
+  beginConversions();
+  stopRequested = false;
+  readerActive = true;
+  if (adc_digi_start() != ESP_OK ||
+      xTaskCreatePinnedToCore(readerTask, "adc_dma", READER_STACK_SIZE, this,
+                              READER_PRIORITY, &readerTaskHandle, APP_CPU_NUM) != pdPASS) {
+    adc_digi_stop();
+    adc_digi_deinitialize();
+    readerTaskHandle = nullptr;
+    readerActive = false;
+    if (debugOutput && Serial) {
+      Serial.println("DMA sampler: start failed!");
+    }
+    return;
+  }
+  running = true;
+
+  if (debugOutput && Serial) {
+    Serial.printf("DMA sampler running at %d Hz, %d conversions per sample (%u Hz)\n",
+                  sampleRate, oversampling, (unsigned)conversionRate);
+  }
+#endif
+}
+
+void DmaSampler::stop() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (readerTaskHandle) {
+    // The reader notices within one read timeout and deletes itself
+    stopRequested = true;
+    while (readerActive) {
+      delay(1);
+    }
+    readerTaskHandle = nullptr;
+    adc_digi_stop();
+    adc_digi_deinitialize();
+  }
+#endif
+  running = false;
+}
+
+uint32_t DmaSampler::getOverflows() const {
+  return overflows;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void DmaSampler::readerTask(void* param) {
+  DmaSampler* sampler = static_cast<DmaSampler*>(param);
+  sampler->readFrames();
+  sampler->readerActive = false;
+  vTaskDelete(nullptr);
+}
+
+void DmaSampler::readFrames() {
+  uint8_t frame[FRAME_CONVERSIONS * CONVERSION_BYTES];
+  uint16_t values[FRAME_CONVERSIONS];
+  while (!stopRequested) {
+    uint32_t length = 0;
+    esp_err_t result = adc_digi_read_bytes(frame, sizeof(frame), &length, 10);
+    if (result == ESP_ERR_INVALID_STATE) {
+      // Driver buffer overran; the returned data is still valid
+      overflows = overflows + 1;
+    } else if (result != ESP_OK) {
+      continue;
+    }
+
+    size_t count = 0;
+    for (uint32_t offset = 0; offset + CONVERSION_BYTES <= length; offset += CONVERSION_BYTES) {
+      const adc_digi_output_data_t* data = reinterpret_cast<const adc_digi_output_data_t*>(frame + offset);
+      values[count++] = data->type1.data;
+    }
+    pushConversions(values, count);
+  }
+}
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Arduino.h>
+#include "oversampling_source.hpp"
+
+// Raw conversions averaged per sample by the DMA backend, 0 keeps the timer-driven Sampler
+#ifndef ADC_OVERSAMPLING
+#define ADC_OVERSAMPLING 64
+#endif
+
+// Continuous ADC1 acquisition through the ESP32 ADC DMA (digital
+// controller) driver. The hardware converts at sampleRate * oversampling
+// Hz into DMA frames without CPU involvement; a reader task decodes each
+// frame and averages `oversampling` conversions per output sample.
+// Without ESP32 hardware start() fails and isRunning() stays false.
+class DmaSampler : public OversamplingSource {
+private:
+    static const uint32_t CONVERSION_RATE_MIN = 20000;  // ESP32 digital controller limits (Hz)
+    static const uint32_t CONVERSION_RATE_MAX = 2000000;
+    static const size_t FRAME_CONVERSIONS = 256;        // Conversions per DMA frame
+    static const size_t CONVERSION_BYTES = 2;           // Type 1 output format
+
+    const int inputPin;
+    volatile uint32_t overflows;  // Driver ring buffer overruns (conversions lost)
+
+#ifdef ARDUINO_ARCH_ESP32
+    static const uint32_t READER_STACK_SIZE = 3072;
+    static const UBaseType_t READER_PRIORITY = 4;  // Above the acquisition task
+    TaskHandle_t readerTaskHandle;
+    volatile bool readerActive;
+    volatile bool stopRequested;
+    static void readerTask(void* param);
+    void readFrames();
+#endif
+
+public:
+    DmaSampler(int pin);
+    void init() override;
+    void start() override;
+    void stop() override;
+
+    uint32_t getOverflows() const;
+};
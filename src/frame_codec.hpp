@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "record_format.hpp"
+
+// Framed binary serial protocol shared by the firmware and host tools.
+//
+// Frame layout (multi-byte fields little-endian):
+//   0xA5 0x5A | type u8 | seq u16 | length u16 | payload[length] | crc32 u32
+// The CRC32 (IEEE 802.3) covers type, seq, length and payload. Text lines
+// never contain 0xA5, so frames can be interleaved with debug output.
+
+static const uint8_t FRAME_SYNC_0 = 0xA5;
+static const uint8_t FRAME_SYNC_1 = 0x5A;
+static const size_t FRAME_HEADER_SIZE = 7;
+static const size_t FRAME_TRAILER_SIZE = 4;
+static const size_t FRAME_MAX_PAYLOAD = 256;
+static const size_t FRAME_MAX_SIZE = FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + FRAME_TRAILER_SIZE;
+
+// Frame types
+static const uint8_t FRAME_DUMP_START = 0x01;  // format u8 | file size u32 | frame count u16
+static const uint8_t FRAME_DUMP_DATA  = 0x02;  // file bytes at offset seq * FRAME_MAX_PAYLOAD
+static const uint8_t FRAME_DUMP_END   = 0x03;  // format u8 | file size u32 | frame count u16 | file crc32 u32
+static const uint8_t FRAME_TELEMETRY  = 0x10;  // dropped samples u16 | SampleRecord[] (seq counts frames)
+static const uint8_t FRAME_TRACE_DATA = 0x20;  // trace events (see trace_format.hpp), seq counts frames
+static const uint8_t FRAME_TRACE_TASK = 0x21;  // task u32 | name (zero-padded, TRACE_TASK_NAME_SIZE bytes)
+static const uint8_t FRAME_TRACE_END  = 0x22;  // events u32 | events overwritten before the dump u32
+
+// Dumped file formats
+static const uint8_t DUMP_FORMAT_CSV = 0;
+static const uint8_t DUMP_FORMAT_BINARY = 1;
+static const uint8_t DUMP_FORMAT_COMPRESSED = 2;
+
+// CRC32 with a 16-entry nibble table - small enough for IRAM/flash, fast enough for the UART
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    crc = ~crc;
+    while (length--) {
+        crc = table[(crc ^ *data) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (*data >> 4)) & 0x0F] ^ (crc >> 4);
+        data++;
+    }
+    return ~crc;
+}
+
+inline uint32_t crc32(const uint8_t* data, size_t length) {
+    return crc32Update(0, data, length);
+}
+
+// Encode a frame into out (at least FRAME_HEADER_SIZE + length + FRAME_TRAILER_SIZE bytes),
+// returns the frame size
+inline size_t encodeFrame(uint8_t type, uint16_t seq, const uint8_t* payload, uint16_t length, uint8_t* out) {
+    out[0] = FRAME_SYNC_0;
+    out[1] = FRAME_SYNC_1;
+    out[2] = type;
+    writeLE16(out + 3, seq);
+    writeLE16(out + 5, length);
+    if (length > 0) {
+        memcpy(out + FRAME_HEADER_SIZE, payload, length);
+    }
+    writeLE32(out + FRAME_HEADER_SIZE + length, crc32(out + 2, FRAME_HEADER_SIZE - 2 + length));
+    return FRAME_HEADER_SIZE + length + FRAME_TRAILER_SIZE;
+}
+
+// Incremental frame parser: feed bytes one at a time, non-frame bytes are
+// reported as text so callers can keep printing debug lines
+class FrameDecoder {
+public:
+    enum Result {
+        NEED_MORE = 0,
+        TEXT_BYTE,     // Byte outside any frame, see lastTextByte()
+        FRAME_OK,      // Complete frame with valid CRC
+        FRAME_BAD_CRC  // Complete frame with CRC mismatch (header fields untrusted)
+    };
+
+private:
+    uint8_t buffer[FRAME_MAX_SIZE];
+    size_t length;
+    uint8_t textByte;
+
+public:
+    FrameDecoder() : length(0), textByte(0) {}
+
+    Result feed(uint8_t byte) {
+        if (length == 0) {
+            if (byte == FRAME_SYNC_0) {
+                buffer[length++] = byte;
+                return NEED_MORE;
+            }
+            textByte = byte;
+            return TEXT_BYTE;
+        }
+        if (length == 1 && byte != FRAME_SYNC_1) {
+            length = 0;
+            return feed(byte);
+        }
+
+        buffer[length++] = byte;
+        if (length < FRAME_HEADER_SIZE) {
+            return NEED_MORE;
+        }
+        size_t payloadLength = readLE16(buffer + 5);
+        if (payloadLength > FRAME_MAX_PAYLOAD) {
+            // Corrupted length field - resynchronise on the next sync byte
+            length = 0;
+            return FRAME_BAD_CRC;
+        }
+        if (length < FRAME_HEADER_SIZE + payloadLength + FRAME_TRAILER_SIZE) {
+            return NEED_MORE;
+        }
+
+        length = 0;
+        uint32_t expected = readLE32(buffer + FRAME_HEADER_SIZE + payloadLength);
+        return crc32(buffer + 2, FRAME_HEADER_SIZE - 2 + payloadLength) == expected ? FRAME_OK : FRAME_BAD_CRC;
+    }
+
+    uint8_t lastTextByte() const { return textByte; }
+    uint8_t type() const { return buffer[2]; }
+    uint16_t seq() const { return readLE16(buffer + 3); }
+    uint16_t payloadLength() const { return readLE16(buffer + 5); }
+    const uint8_t* payload() const { return buffer + FRAME_HEADER_SIZE; }
+};
@@ -1,177 +1,123 @@
 #include "joystick.hpp"
 
+#ifdef ARDUINO_ARCH_ESP32
+#include <soc/gpio_reg.h>
+#endif
+
 Joystick::Joystick() :
-    JOY_UP_PIN(18),
-    JOY_DOWN_PIN(19),
-    JOY_LEFT_PIN(23),
-    JOY_RIGHT_PIN(5),
-    JOY_MID_PIN(13),
-    lastUpState(false),
-    lastDownState(false),
-    lastLeftState(false),
-    lastRightState(false),
-    lastMidState(false),
-    upPressed(false),
-    downPressed(false),
-    leftPressed(false),
-    rightPressed(false),
-    midPressed(false),
-    upWasPressed(false),
-    downWasPressed(false),
-    leftWasPressed(false),
-    rightWasPressed(false),
-    midWasPressed(false),
-    lastUpDebounce(0),
-    lastDownDebounce(0),
-    lastLeftDebounce(0),
-    lastRightDebounce(0),
-    lastMidDebounce(0),
-    debugOutput(false),
-    DEBOUNCE_DELAY(50) {
+    edges(0),
+    pins(0),
+    debounced(0),
+    lastEdge(),
+    droppedEvents(0),
+    debugOutput(false) {
 }
 
-void Joystick::init() {
-  pinMode(JOY_UP_PIN, INPUT_PULLUP);
-  pinMode(JOY_DOWN_PIN, INPUT_PULLUP);
-  pinMode(JOY_LEFT_PIN, INPUT_PULLUP);
-  pinMode(JOY_RIGHT_PIN, INPUT_PULLUP);
-  pinMode(JOY_MID_PIN, INPUT_PULLUP);
+// GPIO input levels with pull-up inverted, bit n set = GPIOn held low
+uint32_t IRAM_ATTR Joystick::readPins() {
+#ifdef ARDUINO_ARCH_ESP32
+  return ~REG_READ(GPIO_IN_REG);
+#else
+  uint32_t result = 0;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    result |= (uint32_t)(digitalRead(PINS[i]) == LOW) << PINS[i];
+  }
+  return result;
+#endif
 }
 
-void Joystick::update() {
-  unsigned long now = millis();
-
-  // Read current states
-  bool upReading = digitalRead(JOY_UP_PIN) == LOW;
-  bool downReading = digitalRead(JOY_DOWN_PIN) == LOW;
-  bool leftReading = digitalRead(JOY_LEFT_PIN) == LOW;
-  bool rightReading = digitalRead(JOY_RIGHT_PIN) == LOW;
-  bool midReading = digitalRead(JOY_MID_PIN) == LOW;
-
-  // Debounce and detect edges for UP
-  if (upReading != lastUpState) {
-    lastUpDebounce = now;
+// Bit i set if button i is held down
+uint32_t Joystick::toButtons(uint32_t levels) {
+  uint32_t result = 0;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    result |= ((levels >> PINS[i]) & 1) << i;
   }
-  if ((now - lastUpDebounce) > DEBOUNCE_DELAY) {
-    if (upReading != upPressed) {
-      upPressed = upReading;
-      upWasPressed = upPressed;  // Set edge detection flag
-      if (upPressed && debugOutput && Serial) {
-        Serial.println("UP pressed");
-      }
-    }
-  }
-  lastUpState = upReading;
+  return result;
+}
 
-  // Debounce and detect edges for DOWN
-  if (downReading != lastDownState) {
-    lastDownDebounce = now;
-  }
-  if ((now - lastDownDebounce) > DEBOUNCE_DELAY) {
-    if (downReading != downPressed) {
-      downPressed = downReading;
-      downWasPressed = downPressed;
-      if (downPressed && debugOutput && Serial) {
-        Serial.println("DOWN pressed");
-      }
-    }
-  }
-  lastDownState = downReading;
+#ifdef ARDUINO_ARCH_ESP32
+// Runs from IRAM and touches only DRAM, so it stays safe during flash writes
+void IRAM_ATTR Joystick::onEdge(void* arg) {
+  PinContext* context = static_cast<PinContext*>(arg);
+  context->joystick->edges.fetch_or(context->mask, std::memory_order_relaxed);
+  context->joystick->pins.store(readPins(), std::memory_order_release);
+}
+#endif
 
-  // Debounce and detect edges for LEFT
-  if (leftReading != lastLeftState) {
-    lastLeftDebounce = now;
-  }
-  if ((now - lastLeftDebounce) > DEBOUNCE_DELAY) {
-    if (leftReading != leftPressed) {
-      leftPressed = leftReading;
-      leftWasPressed = leftPressed;
-      if (leftPressed && debugOutput && Serial) {
-        Serial.println("LEFT pressed");
-      }
-    }
+void Joystick::init() {
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    pinMode(PINS[i], INPUT_PULLUP);
   }
-  lastLeftState = leftReading;
+  pins = readPins();
+  debounced = toButtons(pins);
 
-  // Debounce and detect edges for RIGHT
-  if (rightReading != lastRightState) {
-    lastRightDebounce = now;
+#ifdef ARDUINO_ARCH_ESP32
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    pinContexts[i] = {this, 1u << i};
+    attachInterruptArg(digitalPinToInterrupt(PINS[i]), onEdge, &pinContexts[i], CHANGE);
   }
-  if ((now - lastRightDebounce) > DEBOUNCE_DELAY) {
-    if (rightReading != rightPressed) {
-      rightPressed = rightReading;
-      rightWasPressed = rightPressed;
-      if (rightPressed && debugOutput && Serial) {
-        Serial.println("RIGHT pressed");
-      }
-    }
-  }
-  lastRightState = rightReading;
+#endif
+}
 
-  // Debounce and detect edges for MID
-  if (midReading != lastMidState) {
-    lastMidDebounce = now;
-  }
-  if ((now - lastMidDebounce) > DEBOUNCE_DELAY) {
-    if (midReading != midPressed) {
-      midPressed = midReading;
-      midWasPressed = midPressed;
-      if (midPressed && debugOutput && Serial) {
-        Serial.println("MID pressed");
-      }
+void Joystick::update() {
+  uint32_t now = millis();
+
+#ifdef ARDUINO_ARCH_ESP32
+  uint32_t edgeMask = edges.exchange(0, std::memory_order_acquire);
+  uint32_t current = toButtons(pins.load(std::memory_order_acquire));
+#else
+  // No interrupts on the host - derive the edges by polling
+  uint32_t sampled = readPins();
+  uint32_t current = toButtons(sampled);
+  uint32_t edgeMask = current ^ toButtons(pins.exchange(sampled));
+#endif
+
+  // Buttons that had been quiet for the debounce time before these edges
+  uint32_t quiet = 0;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    if (now - lastEdge[i] >= DEBOUNCE_MS) {
+      quiet |= 1u << i;
+    }
+    if (edgeMask & (1u << i)) {
+      lastEdge[i] = now;
     }
   }
-  lastMidState = midReading;
-}
-
-bool Joystick::isUpPressed() {
-  return upPressed;
-}
-
-bool Joystick::isDownPressed() {
-  return downPressed;
-}
 
-bool Joystick::isLeftPressed() {
-  return leftPressed;
-}
-
-bool Joystick::isRightPressed() {
-  return rightPressed;
-}
-
-bool Joystick::isMidPressed() {
-  return midPressed;
-}
+  // First edge on a quiet, released button is a press, even if it's already
+  // over; a release needs the button quiet and up
+  uint32_t pressed = edgeMask & quiet & ~debounced;
+  uint32_t released = quiet & ~edgeMask & debounced & ~current;
+  debounced = (debounced | pressed) & ~released;
 
-bool Joystick::wasUpPressed() {
-  bool result = upWasPressed;
-  upWasPressed = false;
-  return result;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    uint32_t mask = 1u << i;
+    if (!((pressed | released) & mask)) {
+      continue;
+    }
+    Event event = {static_cast<Button>(i), (pressed & mask) != 0, now};
+    if (!events.push(event)) {
+      droppedEvents++;
+    }
+    if (event.pressed && debugOutput && Serial) {
+      Serial.printf("%s pressed\n", NAMES[i]);
+    }
+  }
 }
 
-bool Joystick::wasDownPressed() {
-  bool result = downWasPressed;
-  downWasPressed = false;
-  return result;
+bool Joystick::nextEvent(Event& event) {
+  return events.pop(event);
 }
 
-bool Joystick::wasLeftPressed() {
-  bool result = leftWasPressed;
-  leftWasPressed = false;
-  return result;
+bool Joystick::isPressed(Button button) const {
+  return debounced & (1u << static_cast<uint8_t>(button));
 }
 
-bool Joystick::wasRightPressed() {
-  bool result = rightWasPressed;
-  rightWasPressed = false;
-  return result;
+uint32_t Joystick::getDroppedEvents() const {
+  return droppedEvents;
 }
 
-bool Joystick::wasMidPressed() {
-  bool result = midWasPressed;
-  midWasPressed = false;
-  return result;
+const char* Joystick::getButtonName(Button button) {
+  return NAMES[static_cast<uint8_t>(button)];
 }
 
 // Debug output control
@@ -181,4 +127,4 @@ bool Joystick::getDebugOutput() const {
 
 void Joystick::setDebugOutput(bool enable) {
   debugOutput = enable;
-}
\ No newline at end of file
+}
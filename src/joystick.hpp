@@ -1,67 +1,75 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
+#include "spsc_queue.hpp"
 
+// Five-way joystick (active low, internal pull-ups).
+// GPIO interrupts latch every edge into an atomic bitmask, so presses
+// shorter than the input period are not lost. update() debounces all five
+// pins at once on that mask: a press is accepted on its first edge, a
+// release once the pin has been quiet for DEBOUNCE_MS. Accepted changes
+// are queued as events.
 class Joystick {
-private:
-    // Joystick pin definitions
-    const int JOY_UP_PIN;
-    const int JOY_DOWN_PIN;
-    const int JOY_LEFT_PIN;
-    const int JOY_RIGHT_PIN;
-    const int JOY_MID_PIN;
+public:
+    enum class Button : uint8_t {
+        UP,
+        DOWN,
+        LEFT,
+        RIGHT,
+        MID
+    };
+
+    struct Event {
+        Button button;
+        bool pressed;        // false for a release
+        uint32_t timestamp;  // millis() when the change was accepted
+    };
 
-    // State tracking for edge detection
-    bool lastUpState;
-    bool lastDownState;
-    bool lastLeftState;
-    bool lastRightState;
-    bool lastMidState;
+    static const uint8_t BUTTON_COUNT = 5;
 
-    // Current debounced states
-    bool upPressed;
-    bool downPressed;
-    bool leftPressed;
-    bool rightPressed;
-    bool midPressed;
+private:
+    static const uint32_t DEBOUNCE_MS = 50;
+    static const size_t EVENT_QUEUE_SIZE = 16;
 
-    // Edge detection states (true until cleared by wasPressed functions)
-    bool upWasPressed;
-    bool downWasPressed;
-    bool leftWasPressed;
-    bool rightWasPressed;
-    bool midWasPressed;
+    // Pin of each Button, in enum order (all below 32 so one register read covers them)
+    inline static constexpr uint8_t PINS[BUTTON_COUNT] = {18, 19, 23, 5, 13};
+    inline static const char* const NAMES[BUTTON_COUNT] = {"UP", "DOWN", "LEFT", "RIGHT", "MID"};
 
-    // Last debounce times
-    unsigned long lastUpDebounce;
-    unsigned long lastDownDebounce;
-    unsigned long lastLeftDebounce;
-    unsigned long lastRightDebounce;
-    unsigned long lastMidDebounce;
+    std::atomic<uint32_t> edges;   // Buttons with an edge since the last update (ISR side)
+    std::atomic<uint32_t> pins;    // Latest GPIO levels from readPins()
+    uint32_t debounced;            // Accepted state, bit set = pressed
+    uint32_t lastEdge[BUTTON_COUNT];
+    SpscQueue<Event, EVENT_QUEUE_SIZE> events;
+    uint32_t droppedEvents;
 
     // Debug output control
     bool debugOutput;
 
-    // Debounce delay in milliseconds
-    const unsigned long DEBOUNCE_DELAY;
+    static uint32_t readPins();
+    static uint32_t toButtons(uint32_t levels);
+
+#ifdef ARDUINO_ARCH_ESP32
+    struct PinContext {
+        Joystick* joystick;
+        uint32_t mask;
+    };
+    PinContext pinContexts[BUTTON_COUNT];
+    static void onEdge(void* arg);
+#endif
 
 public:
     Joystick();
     void init();
     void update();
 
-    // Button controls and getters
-    bool isUpPressed();
-    bool isDownPressed();
-    bool isLeftPressed();
-    bool isRightPressed();
-    bool isMidPressed();
+    // Next debounced press or release, false if none is queued
+    bool nextEvent(Event& event);
+
+    bool isPressed(Button button) const;
+    uint32_t getDroppedEvents() const;
 
-    bool wasUpPressed();
-    bool wasDownPressed();
-    bool wasLeftPressed();
-    bool wasRightPressed();
-    bool wasMidPressed();
+    static const char* getButtonName(Button button);
 
     // Debug output control
     bool getDebugOutput() const;
@@ -1,14 +1,61 @@
 #include <Arduino.h>
 #include "display.hpp"
 #include "joystick.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
 #include "sensor.hpp"
+#include "sensor_event.hpp"
 #include "data_logger.hpp"
+#include "sampler.hpp"
+#include "dma_sampler.hpp"
+#include "scheduler.hpp"
+#include "telemetry.hpp"
+
+// Serial baud rate, the auto-save listener must use the same (make BAUD=...)
+#ifndef SERIAL_BAUD_RATE
+#define SERIAL_BAUD_RATE 921600
+#endif
+
+// Task configuration - acquisition/detection runs alone on APP_CPU so display
+// I2C transfers and SPIFFS writes on PRO_CPU can't delay sampling
+static const uint32_t DETECTION_PERIOD_MS = 10;
+static const uint32_t INPUT_PERIOD_MS = 20;
+static const uint32_t EVENTS_PERIOD_MS = 20;
+static const uint32_t SERVICE_PERIOD_MS = 20;
+static const uint32_t LOG_PERIOD_MS = 50;     // 20 Hz recording
+static const uint32_t ACQUISITION_STACK_SIZE = 4096;
+static const uint32_t CONTROL_STACK_SIZE = 8192;
+static const uint32_t DISPLAY_STACK_SIZE = 4096;
+static const UBaseType_t ACQUISITION_PRIORITY = 3;
+static const UBaseType_t CONTROL_PRIORITY = 1;
+static const UBaseType_t DISPLAY_PRIORITY = 1;
+static const uint32_t DISPLAY_PERIOD_MS = 100;
+static const uint32_t STATUS_PERIOD_MS = 10000;
 
 DataLogger dataLogger;
+Sampler sampler(Sensor::getPulseInputPin());
+DmaSampler dmaSampler(Sensor::getPulseInputPin());
+AcquisitionSource* acquisition = &sampler;
+Telemetry telemetry;
 Sensor sensor(dataLogger);
 Display display(sensor, dataLogger);
 Joystick joystick;
 
+SensorEventQueue sensorEvents;
+volatile uint32_t droppedSensorEvents = 0;
+TaskHandle_t acquisitionTaskHandle = nullptr;
+TaskHandle_t controlTaskHandle = nullptr;
+TaskHandle_t displayTaskHandle = nullptr;
+bool pipelineDebugOutput = false;
+
+// Periodic jobs of the acquisition and control tasks
+Scheduler acquisitionScheduler("acquisition");
+Scheduler controlScheduler("control");
+
+// Control task state shared by its jobs
+SensorEvent latestEvent = {};
+bool beatSinceLastRecord = false;
+
 enum class ScreenState {
     BPM_DISPLAY,
     SIGNAL_DISPLAY,
@@ -17,24 +64,99 @@ enum class ScreenState {
 
 ScreenState currentScreen = ScreenState::BPM_DISPLAY;
 
-void setup() {
-  Serial.begin(115200);
-  
-  display.init();
-  joystick.init();
-  dataLogger.init();
-  sensor.init();
+// Host commands arrive as text lines on Serial
+char commandBuffer[64];
+size_t commandLength = 0;
+
+// APP_CPU: drain the sampler, run beat detection, publish events
+void runDetection() {
+  {
+    PROFILE_SCOPE(SENSOR_UPDATE);
+    TRACE_SCOPE(SENSOR_UPDATE);
+    sensor.update();
+  }
+
+  SensorEvent event;
+  event.timestamp = millis();
+  event.signal = sensor.getSignal();
+  event.signalMin = sensor.getSignalMin();
+  event.signalMax = sensor.getSignalMax();
+  event.peak = sensor.getPeakValue();
+  event.trough = sensor.getTroughValue();
+  event.threshold = sensor.getEffectiveThreshold();
+  event.bpm = sensor.getBPM();
+  event.beatDetected = sensor.isBeatDetected();
+  if (!sensorEvents.push(event)) {
+    droppedSensorEvents = droppedSensorEvents + 1;
+  }
 }
 
-void loop() {
-  joystick.update();
-  sensor.update();
-  
-  // Update signal history for graph display
-  display.updateSignalHistory(sensor.getSignal());
+void acquisitionTask(void* param) {
+  acquisitionScheduler.run();
+}
 
+void reportStackUsage() {
+  // High-water marks are the minimum free stack (bytes) seen so far
+  Serial.printf("Stack free: acquisition %u B, control %u B, display %u B | dropped events: %u, dropped samples: %u, dropped telemetry: %u\n",
+                (unsigned)uxTaskGetStackHighWaterMark(acquisitionTaskHandle),
+                (unsigned)uxTaskGetStackHighWaterMark(controlTaskHandle),
+                (unsigned)uxTaskGetStackHighWaterMark(displayTaskHandle),
+                (unsigned)droppedSensorEvents, (unsigned)acquisition->getDroppedSamples(),
+                (unsigned)telemetry.getDroppedSamples());
+  const PartialSSD1306::FrameStats& frame = display.getFrameStats();
+  const Display::RenderStats& render = display.getRenderStats();
+  Serial.printf("Display: %u fps, %u dropped | last frame %u us (%u B, %u pages), max %u us\n",
+                (unsigned)render.framesPerSecond, (unsigned)render.droppedFrames,
+                (unsigned)frame.lastFrameMicros, (unsigned)frame.lastFrameBytes,
+                (unsigned)frame.lastFramePages, (unsigned)frame.maxFrameMicros);
+}
+
+void handleSerialCommand(const char* command) {
+  if (strncmp(command, "RESEND ", 7) == 0) {
+    dataLogger.requestResend(atoi(command + 7));
+  } else if (strcmp(command, "ACK") == 0) {
+    dataLogger.acknowledgeDump();
+  } else if (strcmp(command, "FILTER ON") == 0) {
+    sensor.setFilterEnabled(true);
+  } else if (strcmp(command, "FILTER OFF") == 0) {
+    sensor.setFilterEnabled(false);
+  } else if (strcmp(command, "STREAM ON") == 0) {
+    telemetry.start();
+  } else if (strcmp(command, "STREAM OFF") == 0) {
+    telemetry.stop();
+  } else if (strcmp(command, "PROFILE") == 0) {
+    Profiler::report();
+  } else if (strcmp(command, "PROFILE RESET") == 0) {
+    Profiler::reset();
+  } else if (strcmp(command, "TRACE") == 0) {
+    Trace::startDump();
+  } else if (strcmp(command, "SCHED") == 0) {
+    acquisitionScheduler.report();
+    controlScheduler.report();
+  } else if (strcmp(command, "SCHED RESET") == 0) {
+    acquisitionScheduler.resetStats();
+    controlScheduler.resetStats();
+  }
+}
+
+void readSerialCommands() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c == '\n' || c == '\r') {
+      if (commandLength > 0) {
+        commandBuffer[commandLength] = '\0';
+        handleSerialCommand(commandBuffer);
+        commandLength = 0;
+      }
+    } else if (commandLength < sizeof(commandBuffer) - 1) {
+      commandBuffer[commandLength++] = c;
+    }
+  }
+}
+
+void handleButtonPress(Joystick::Button button) {
   // Toggle screens on middle button press
-  if (joystick.wasMidPressed()) {
+  if (button == Joystick::Button::MID) {
     switch (currentScreen) {
       case ScreenState::BPM_DISPLAY:
         currentScreen = ScreenState::SIGNAL_DISPLAY;
@@ -46,62 +168,187 @@ void loop() {
         currentScreen = ScreenState::BPM_DISPLAY;
         break;
     }
+    return;
   }
 
   // Settings navigation (only when in settings menu)
   if (currentScreen == ScreenState::SETTINGS_MENU) {
-    if (joystick.wasUpPressed()) {
-      display.handleUpMovement();
-    }
-    if (joystick.wasDownPressed()) {
-      display.handleDownMovement();
-    }
-    if (joystick.wasLeftPressed()) {
-      display.handleLeftMovement();
+    switch (button) {
+      case Joystick::Button::UP:
+        display.handleUpMovement();
+        break;
+      case Joystick::Button::DOWN:
+        display.handleDownMovement();
+        break;
+      case Joystick::Button::LEFT:
+        display.handleLeftMovement();
+        break;
+      case Joystick::Button::RIGHT:
+        display.handleRightMovement();
+        break;
+      default:
+        break;
     }
-    if (joystick.wasRightPressed()) {
-      display.handleRightMovement();
+    return;
+  }
+
+  // Graph time window on the signal screen
+  if (currentScreen == ScreenState::SIGNAL_DISPLAY) {
+    if (button == Joystick::Button::UP) {
+      display.handleGraphZoomIn();
+    } else if (button == Joystick::Button::DOWN) {
+      display.handleGraphZoomOut();
     }
-  } else if (currentScreen == ScreenState::BPM_DISPLAY || currentScreen == ScreenState::SIGNAL_DISPLAY) {
-    // Direct recording toggle when in BPM display or Signal display modes
-    if (joystick.wasLeftPressed() || joystick.wasRightPressed()) {
-      if (dataLogger.isRecording()) {
-        dataLogger.stopRecording();
-      } else {
-        dataLogger.startRecording("/sensor_data.csv");
-      }
+  }
+
+  // Direct recording toggle when in BPM display or Signal display modes
+  if (button == Joystick::Button::LEFT || button == Joystick::Button::RIGHT) {
+    if (dataLogger.isRecording()) {
+      dataLogger.stopRecording();
+    } else {
+      dataLogger.startRecording();
     }
   }
+}
 
-  // Update display every 100ms
-  static unsigned long lastDisplayUpdate = 0;
-  if (millis() - lastDisplayUpdate > 100) {
-    switch (currentScreen) {
-      case ScreenState::BPM_DISPLAY:
-        {
-          int currentBPM = sensor.getBPM();
-          display.showBPM(currentBPM);
-        }
-        break;
-      case ScreenState::SIGNAL_DISPLAY:
-        display.showSignalGraph();
-        break;
-      case ScreenState::SETTINGS_MENU:
-        display.showMenu();
-        break;
+void handleInput() {
+  {
+    PROFILE_SCOPE(JOYSTICK);
+    TRACE_SCOPE(JOYSTICK);
+    joystick.update();
+  }
+
+  Joystick::Event event;
+  while (joystick.nextEvent(event)) {
+    if (event.pressed) {
+      handleButtonPress(event.button);
     }
-    lastDisplayUpdate = millis();
   }
+}
+
+// PRO_CPU: renders the newest display snapshot whenever one is published;
+// I2C transfers run in the panel's own transmit task
+void displayTask(void* param) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    display.renderLatest();
+  }
+}
+
+DisplaySnapshot::Screen snapshotScreen(ScreenState screen) {
+  switch (screen) {
+    case ScreenState::SIGNAL_DISPLAY:
+      return DisplaySnapshot::Screen::SIGNAL_GRAPH;
+    case ScreenState::SETTINGS_MENU:
+      return DisplaySnapshot::Screen::MENU;
+    default:
+      return DisplaySnapshot::Screen::BPM;
+  }
+}
+
+// PRO_CPU jobs: joystick, display snapshots, data logging and serial
+// traffic, fed by acquisition events
 
-  // Record data every 50ms (20Hz) to avoid disrupting sensor timing
-  static unsigned long lastRecordTime = 0;
-  if (dataLogger.isRecording() && millis() - lastRecordTime > 50) {
-    dataLogger.logData(millis(), sensor.getSignal(), sensor.getPeakValue(), 
-                      sensor.getTroughValue(), sensor.getEffectiveThreshold(), 
-                      sensor.isBeatDetected(), sensor.getBPM());
-    dataLogger.checkAutoStop();
-    lastRecordTime = millis();
+// Consume everything the acquisition task published since the last run
+void drainSensorEvents() {
+  SensorEvent event;
+  while (sensorEvents.pop(event)) {
+    // Update signal envelope for graph display
+    display.updateSignalHistory(event.signalMin, event.signalMax, event.timestamp);
+    beatSinceLastRecord = beatSinceLastRecord || event.beatDetected;
+    latestEvent = event;
   }
+}
+
+// Hand a display snapshot to the render task, never waiting on it
+void publishDisplay() {
+  display.publishSnapshot(snapshotScreen(currentScreen), latestEvent.bpm);
+  xTaskNotifyGive(displayTaskHandle);
+}
+
+// Record one row; beats between records are carried over
+void logSample() {
+  if (!dataLogger.isRecording()) {
+    return;
+  }
+  {
+    PROFILE_SCOPE(LOG_DATA);
+    TRACE_SCOPE(LOG_DATA);
+    dataLogger.logData(latestEvent.timestamp, latestEvent.signal, latestEvent.peak,
+                       latestEvent.trough, latestEvent.threshold,
+                       beatSinceLastRecord, latestEvent.bpm);
+  }
+  beatSinceLastRecord = false;
+  dataLogger.checkAutoStop();
+}
+
+// Host commands and a bounded piece of any pending recording dump, live telemetry and trace dump
+void serviceSerial() {
+  readSerialCommands();
+  dataLogger.serviceDump();
+  telemetry.service();
+  Trace::service();
+}
 
-  delay(20);
+void reportStatus() {
+  if (pipelineDebugOutput && Serial) {
+    reportStackUsage();
+  }
+}
+
+void controlTask(void* param) {
+  controlScheduler.run();
+}
+
+void setup() {
+  // Large TX buffer lets recording dumps stream without blocking on the UART
+  Serial.setTxBufferSize(4096);
+  Serial.begin(SERIAL_BAUD_RATE);
+
+  display.init();
+  joystick.init();
+  dataLogger.init();
+  dataLogger.setRecordingFormat(DataLogger::RecordingFormat::COMPRESSED);
+  dataLogger.setDumpMode(DataLogger::DumpMode::FRAMED);
+  sensor.init();
+  sensor.setTelemetry(&telemetry);
+
+  if (SAMPLE_RATE_HZ > 0) {
+    // Prefer DMA acquisition, fall back to the timer if the ADC driver refuses it
+    if (ADC_OVERSAMPLING > 0) {
+      dmaSampler.setSampleRate(SAMPLE_RATE_HZ);
+      dmaSampler.setOversampling(ADC_OVERSAMPLING);
+      dmaSampler.init();
+      dmaSampler.start();
+      if (dmaSampler.isRunning()) {
+        acquisition = &dmaSampler;
+      }
+    }
+    if (!acquisition->isRunning()) {
+      sampler.setSampleRate(SAMPLE_RATE_HZ);
+      sampler.init();
+      sampler.start();
+    }
+    sensor.setSampler(acquisition);
+  }
+
+  acquisitionScheduler.addJob("detection", runDetection, DETECTION_PERIOD_MS);
+  controlScheduler.addJob("input", handleInput, INPUT_PERIOD_MS);
+  controlScheduler.addJob("events", drainSensorEvents, EVENTS_PERIOD_MS);
+  controlScheduler.addJob("display", publishDisplay, DISPLAY_PERIOD_MS);
+  controlScheduler.addJob("logging", logSample, LOG_PERIOD_MS);
+  controlScheduler.addJob("serial", serviceSerial, SERVICE_PERIOD_MS);
+  controlScheduler.addJob("status", reportStatus, STATUS_PERIOD_MS);
+
+  xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQUISITION_STACK_SIZE, nullptr,
+                          ACQUISITION_PRIORITY, &acquisitionTaskHandle, APP_CPU_NUM);
+  xTaskCreatePinnedToCore(displayTask, "display", DISPLAY_STACK_SIZE, nullptr,
+                          DISPLAY_PRIORITY, &displayTaskHandle, PRO_CPU_NUM);
+  xTaskCreatePinnedToCore(controlTask, "control", CONTROL_STACK_SIZE, nullptr,
+                          CONTROL_PRIORITY, &controlTaskHandle, PRO_CPU_NUM);
+}
+
+void loop() {
+  // All work happens in the pinned tasks
+  vTaskDelete(nullptr);
 }
@@ -0,0 +1,85 @@
+#include "oversampling_source.hpp"
+
+OversamplingSource::OversamplingSource() :
+    droppedSamples(0),
+    accumulator(0),
+    accumulated(0),
+    outputCount(0),
+    startMillis(0),
+    sampleRate(DEFAULT_SAMPLE_RATE),
+    oversampling(OVERSAMPLING_MIN),
+    running(false),
+    debugOutput(false) {
+}
+
+void OversamplingSource::beginConversions() {
+  accumulator = 0;
+  accumulated = 0;
+  outputCount = 0;
+  startMillis = millis();
+}
+
+void OversamplingSource::pushConversions(const uint16_t* values, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    accumulator += values[i];
+    if (++accumulated < oversampling) {
+      continue;
+    }
+
+    Sample sample;
+    sample.timestamp = startMillis + (uint32_t)((uint64_t)outputCount * 1000 / sampleRate);
+    sample.value = (accumulator + oversampling / 2) / oversampling;
+    if (!queue.push(sample)) {
+      droppedSamples = droppedSamples + 1;
+    }
+    outputCount++;
+    accumulator = 0;
+    accumulated = 0;
+  }
+}
+
+bool OversamplingSource::isRunning() const {
+  return running;
+}
+
+size_t OversamplingSource::read(Sample* out, size_t maxSamples) {
+  return queue.popBatch(out, maxSamples);
+}
+
+size_t OversamplingSource::getQueuedSamples() const {
+  return queue.size();
+}
+
+uint32_t OversamplingSource::getDroppedSamples() const {
+  return droppedSamples;
+}
+
+// Sampling rate configuration methods
+void OversamplingSource::setSampleRate(int rate) {
+  sampleRate = max(SAMPLE_RATE_MIN, min(SAMPLE_RATE_MAX, rate));
+}
+
+int OversamplingSource::getSampleRate() const {
+  return sampleRate;
+}
+
+void OversamplingSource::setOversampling(int factor) {
+  oversampling = max(OVERSAMPLING_MIN, min(OVERSAMPLING_MAX, factor));
+}
+
+int OversamplingSource::getOversampling() const {
+  return oversampling;
+}
+
+uint32_t OversamplingSource::getConversionRate() const {
+  return (uint32_t)sampleRate * oversampling;
+}
+
+// Debug output control
+bool OversamplingSource::getDebugOutput() const {
+  return debugOutput;
+}
+
+void OversamplingSource::setDebugOutput(bool enable) {
+  debugOutput = enable;
+}
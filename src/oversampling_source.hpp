@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include "acquisition_source.hpp"
+#include "spsc_queue.hpp"
+
+// Base for continuously converting backends: raw conversions arrive in
+// bursts at sampleRate * oversampling Hz, every `oversampling` consecutive
+// conversions are averaged into one output sample (sqrt(N) less white noise)
+// and queued for Sensor. Timestamps come from the output sample count, so
+// they stay exact however late the bursts are delivered.
+class OversamplingSource : public AcquisitionSource {
+private:
+    static const int DEFAULT_SAMPLE_RATE = 500;  // Hz
+    static const int SAMPLE_RATE_MIN = 250;
+    static const int SAMPLE_RATE_MAX = 1000;
+    static const int OVERSAMPLING_MIN = 1;
+    static const int OVERSAMPLING_MAX = 256;
+    static const size_t QUEUE_SIZE = 512;        // ~0.5 s of headroom at 1 kHz
+
+    SpscQueue<Sample, QUEUE_SIZE> queue;
+    volatile uint32_t droppedSamples;
+    uint32_t accumulator;
+    int accumulated;
+    uint32_t outputCount;      // Samples produced since start()
+    uint32_t startMillis;
+
+protected:
+    int sampleRate;
+    int oversampling;
+    bool running;
+    bool debugOutput;
+
+    // Producer side: reset the decimator at start(), then feed every conversion
+    void beginConversions();
+    void pushConversions(const uint16_t* values, size_t count);
+
+public:
+    OversamplingSource();
+
+    bool isRunning() const override;
+
+    size_t read(Sample* out, size_t maxSamples) override;
+    size_t getQueuedSamples() const override;
+    uint32_t getDroppedSamples() const override;
+
+    int getSampleRate() const override;
+    void setSampleRate(int rate) override;
+    static int getSampleRateMin() { return SAMPLE_RATE_MIN; }
+    static int getSampleRateMax() { return SAMPLE_RATE_MAX; }
+
+    // Raw conversions averaged per output sample (takes effect on next start())
+    int getOversampling() const;
+    void setOversampling(int factor);
+    static int getOversamplingMin() { return OVERSAMPLING_MIN; }
+    static int getOversamplingMax() { return OVERSAMPLING_MAX; }
+    uint32_t getConversionRate() const;
+
+    // Debug output control
+    bool getDebugOutput() const;
+    void setDebugOutput(bool enable);
+};
@@ -0,0 +1,171 @@
+#include "partial_ssd1306.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
+
+PartialSSD1306::PartialSSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin, uint32_t i2cClock) :
+    Adafruit_SSD1306(w, h, twi, rst_pin, i2cClock),
+    shadow(nullptr),
+    frontBuffer(nullptr),
+    transmitPending(false),
+    fullRefresh(true),
+    stats() {
+#ifdef ARDUINO_ARCH_ESP32
+  transmitTaskHandle = nullptr;
+#endif
+}
+
+PartialSSD1306::~PartialSSD1306() {
+  free(shadow);
+  free(frontBuffer);
+}
+
+bool PartialSSD1306::begin(uint8_t switchvcc, uint8_t i2caddr) {
+  if (!Adafruit_SSD1306::begin(switchvcc, i2caddr)) {
+    return false;
+  }
+  size_t frameSize = _width * ((_height + 7) / 8);
+  if (!shadow) {
+    shadow = static_cast<uint8_t*>(malloc(frameSize));
+  }
+  if (!frontBuffer) {
+    frontBuffer = static_cast<uint8_t*>(calloc(frameSize, 1));
+  }
+  if (!shadow || !frontBuffer) {
+    return false;
+  }
+  invalidate();
+
+#ifdef ARDUINO_ARCH_ESP32
+  if (!transmitTaskHandle) {
+    xTaskCreatePinnedToCore(transmitTask, "oled", TRANSMIT_TASK_STACK_SIZE, this,
+                            TRANSMIT_TASK_PRIORITY, &transmitTaskHandle, PRO_CPU_NUM);
+  }
+#endif
+  return true;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void PartialSSD1306::transmitTask(void* param) {
+  PartialSSD1306* panel = static_cast<PartialSSD1306*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (panel->transmitPending.load(std::memory_order_acquire)) {
+      panel->transmit(panel->frontBuffer);
+      panel->transmitPending.store(false, std::memory_order_release);
+    }
+  }
+}
+#endif
+
+void PartialSSD1306::invalidate() {
+  fullRefresh = true;
+}
+
+void PartialSSD1306::display() {
+  transmit(buffer);
+}
+
+bool PartialSSD1306::present() {
+  if (transmitPending.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  // The finished frame becomes the front buffer, drawing continues in the other one
+  uint8_t* finished = buffer;
+  buffer = frontBuffer;
+  frontBuffer = finished;
+  transmitPending.store(true, std::memory_order_release);
+
+#ifdef ARDUINO_ARCH_ESP32
+  if (transmitTaskHandle) {
+    xTaskNotifyGive(transmitTaskHandle);
+    return true;
+  }
+#endif
+  // No background task (host builds) - transmit inline
+  transmit(frontBuffer);
+  transmitPending.store(false, std::memory_order_release);
+  return true;
+}
+
+bool PartialSSD1306::isTransmitting() const {
+  return transmitPending.load(std::memory_order_acquire);
+}
+
+void PartialSSD1306::transmit(const uint8_t* frame) {
+  PROFILE_SCOPE(I2C_PUSH);
+  TRACE_SCOPE(I2C_PUSH);
+  unsigned long started = micros();
+  const uint8_t pages = (_height + 7) / 8;
+  uint32_t bytesSent = 0;
+  uint8_t pagesSent = 0;
+
+  wire->setClock(wireClk);
+  for (uint8_t page = 0; page < pages; page++) {
+    const uint8_t* row = frame + page * _width;
+    uint8_t* shadowRow = shadow + page * _width;
+
+    // Changed column span of this page
+    int first = 0;
+    int last = _width - 1;
+    if (!fullRefresh) {
+      while (first < _width && row[first] == shadowRow[first]) {
+        first++;
+      }
+      if (first == _width) {
+        continue;
+      }
+      while (row[last] == shadowRow[last]) {
+        last--;
+      }
+    }
+
+    sendPage(frame, page, first, last);
+    memcpy(shadowRow + first, row + first, last - first + 1);
+    bytesSent += last - first + 1;
+    pagesSent++;
+  }
+  wire->setClock(restoreClk);
+  fullRefresh = false;
+
+  uint32_t elapsed = micros() - started;
+  stats.frames++;
+  stats.lastFrameMicros = elapsed;
+  stats.maxFrameMicros = max(stats.maxFrameMicros, elapsed);
+  stats.lastFrameBytes = bytesSent;
+  stats.totalBytes += bytesSent;
+  stats.lastFramePages = pagesSent;
+}
+
+void PartialSSD1306::sendPage(const uint8_t* frame, uint8_t page, uint8_t firstColumn, uint8_t lastColumn) {
+  // Address window = one page, changed columns only
+  const uint8_t window[] = {
+    SSD1306_PAGEADDR, page, page,
+    SSD1306_COLUMNADDR, firstColumn, lastColumn
+  };
+  ssd1306_commandList(window, sizeof(window));
+
+  const uint8_t* data = frame + page * _width + firstColumn;
+  size_t remaining = lastColumn - firstColumn + 1;
+  while (remaining > 0) {
+    size_t chunk = remaining < WIRE_CHUNK ? remaining : WIRE_CHUNK;
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x40);
+    wire->write(data, chunk);
+    wire->endTransmission();
+    data += chunk;
+    remaining -= chunk;
+  }
+}
+
+void PartialSSD1306::setI2CClock(uint32_t frequency) {
+  wireClk = max(I2C_CLOCK_MIN, min(I2C_CLOCK_MAX, frequency));
+}
+
+uint32_t PartialSSD1306::getI2CClock() const {
+  return wireClk;
+}
+
+const PartialSSD1306::FrameStats& PartialSSD1306::getFrameStats() const {
+  return stats;
+}
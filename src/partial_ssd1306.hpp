@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SSD1306.h>
+#include <atomic>
+
+// SSD1306 driver that only transmits what changed since the last frame.
+// Transmission compares a frame with a shadow copy of the panel contents
+// and sends, per 8-pixel page, just the span of changed columns. Screens can
+// keep redrawing from scratch every frame; unchanged pages cost a memcmp
+// instead of 128 bytes of I2C traffic.
+//
+// Frames are double buffered: drawing goes to the back buffer while
+// present() hands the previous one to a background transmit task, so the
+// renderer never waits on the I2C bus unless it outruns it.
+class PartialSSD1306 : public Adafruit_SSD1306 {
+public:
+    struct FrameStats {
+        uint32_t frames;           // Frames transmitted
+        uint32_t lastFrameMicros;  // Duration of the last transmission
+        uint32_t maxFrameMicros;
+        uint32_t lastFrameBytes;   // Data bytes sent in the last frame
+        uint32_t totalBytes;
+        uint8_t  lastFramePages;   // Pages touched in the last frame
+    };
+
+private:
+    // Bytes per I2C transmission (Wire buffer size, minus the control byte)
+#ifdef I2C_BUFFER_LENGTH
+    static const size_t WIRE_CHUNK = I2C_BUFFER_LENGTH - 1;
+#else
+    static const size_t WIRE_CHUNK = 31;
+#endif
+
+    static const uint32_t I2C_CLOCK_MIN = 100000;
+    static const uint32_t I2C_CLOCK_MAX = 1000000;
+
+    uint8_t* shadow;        // Panel contents as of the last transmission
+    uint8_t* frontBuffer;   // Frame handed to the transmit path
+    std::atomic<bool> transmitPending;
+    bool fullRefresh;       // Panel contents unknown, send everything
+    FrameStats stats;
+
+#ifdef ARDUINO_ARCH_ESP32
+    static const uint32_t TRANSMIT_TASK_STACK_SIZE = 3072;
+    static const UBaseType_t TRANSMIT_TASK_PRIORITY = 1;
+    TaskHandle_t transmitTaskHandle;
+    static void transmitTask(void* param);
+#endif
+
+    void transmit(const uint8_t* frame);
+    void sendPage(const uint8_t* frame, uint8_t page, uint8_t firstColumn, uint8_t lastColumn);
+
+public:
+    PartialSSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin, uint32_t i2cClock);
+    ~PartialSSD1306();
+
+    // Allocates both framebuffers and starts the transmit task
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0);
+
+    void display();      // Synchronous push of the back buffer (before rendering starts)
+    bool present();      // Swap buffers and transmit in the background; false while the previous frame is still in flight
+    bool isTransmitting() const;
+    void invalidate();   // Force the next transmission to send the whole frame
+
+    // I2C clock used during transfers (SSD1306 is rated for 400 kHz, most
+    // modules run fine at 1 MHz)
+    void setI2CClock(uint32_t frequency);
+    uint32_t getI2CClock() const;
+    static uint32_t getI2CClockMin() { return I2C_CLOCK_MIN; }
+    static uint32_t getI2CClockMax() { return I2C_CLOCK_MAX; }
+
+    const FrameStats& getFrameStats() const;
+};
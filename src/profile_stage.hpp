@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+// Instrumented stages of the firmware pipeline, shared by the profiler, the
+// event trace and the host tools. Each stage runs in exactly one task.
+enum class ProfileStage : uint8_t {
+    JOYSTICK,        // joystick.update()
+    SENSOR_UPDATE,   // sensor.update()
+    DISPLAY_RENDER,  // Drawing a snapshot into the back buffer
+    I2C_PUSH,        // Sending a frame to the panel
+    LOG_DATA,        // dataLogger.logData()
+    COUNT
+};
+
+inline const char* profileStageName(ProfileStage stage) {
+    switch (stage) {
+        case ProfileStage::JOYSTICK: return "joystick";
+        case ProfileStage::SENSOR_UPDATE: return "sensor_update";
+        case ProfileStage::DISPLAY_RENDER: return "display_render";
+        case ProfileStage::I2C_PUSH: return "i2c_push";
+        case ProfileStage::LOG_DATA: return "log_data";
+        default: return "?";
+    }
+}
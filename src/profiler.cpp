@@ -0,0 +1,59 @@
+#include "profiler.hpp"
+
+bool Profiler::isEnabled() {
+#ifdef ENABLE_PROFILER
+  return true;
+#else
+  return false;
+#endif
+}
+
+void Profiler::report() {
+  if (!Serial) {
+    return;
+  }
+#ifdef ENABLE_PROFILER
+#ifdef ARDUINO_ARCH_ESP32
+  uint32_t cyclesPerMicro = getCpuFrequencyMhz();
+#else
+  uint32_t cyclesPerMicro = 0;  // Host counter rate is unknown, report cycles only
+#endif
+  Serial.printf("Profile (cycles%s):\n", cyclesPerMicro ? ", us in brackets" : "");
+  Serial.printf("%-16s %8s %10s %10s %10s\n", "stage", "count", "min", "mean", "max");
+  for (int i = 0; i < static_cast<int>(ProfileStage::COUNT); i++) {
+    ProfileStage stage = static_cast<ProfileStage>(i);
+    const Stats& s = stats[i];
+    if (s.count == 0) {
+      continue;
+    }
+    uint32_t mean = s.totalCycles / s.count;
+    Serial.printf("%-16s %8u %10u %10u %10u", profileStageName(stage), (unsigned)s.count,
+                  (unsigned)s.minCycles, (unsigned)mean, (unsigned)s.maxCycles);
+    if (cyclesPerMicro) {
+      Serial.printf("  [%u / %u / %u us]", (unsigned)(s.minCycles / cyclesPerMicro),
+                    (unsigned)(mean / cyclesPerMicro), (unsigned)(s.maxCycles / cyclesPerMicro));
+    }
+    Serial.println();
+
+    // Log2 buckets between the shortest and longest scope
+    Serial.print("  ");
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+      if (s.histogram[b]) {
+        Serial.printf(" <2^%d:%u", b + 1, (unsigned)s.histogram[b]);
+      }
+    }
+    Serial.println();
+  }
+#else
+  Serial.println(F("Profiler disabled, build with -DENABLE_PROFILER"));
+#endif
+}
+
+void Profiler::reset() {
+#ifdef ENABLE_PROFILER
+  // Stages may be recording concurrently; a sample landing mid-reset only skews one count
+  for (Stats& s : stats) {
+    s = {0, UINT32_MAX, 0, 0, {}};
+  }
+#endif
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Arduino.h>
+#include "profile_stage.hpp"
+
+#if !defined(ARDUINO_ARCH_ESP32) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+// Per-stage cycle profiler.
+//
+// PROFILE_SCOPE(stage) times the rest of the enclosing block with the CPU
+// cycle counter and adds it to the stage's min/mean/max and log2 histogram.
+// Scopes compile to nothing unless ENABLE_PROFILER is defined (build with
+// -DENABLE_PROFILER); the report is printed by the PROFILE serial command.
+//
+// Every stage is timed from a single task, so the statistics need no
+// locking; tasks are pinned, so a scope never spans two cores' counters.
+
+class Profiler {
+public:
+    static const int HISTOGRAM_BUCKETS = 32;  // Bucket b counts [2^b, 2^(b+1)) cycles
+
+    struct Stats {
+        uint32_t count;
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint32_t histogram[HISTOGRAM_BUCKETS];
+    };
+
+    static inline uint32_t cycles() {
+#ifdef ARDUINO_ARCH_ESP32
+        return ESP.getCycleCount();
+#elif defined(__x86_64__) || defined(__i386__)
+        return static_cast<uint32_t>(__rdtsc());
+#else
+        return micros();
+#endif
+    }
+
+    static inline void record(ProfileStage stage, uint32_t elapsed) {
+        Stats& s = stats[static_cast<int>(stage)];
+        s.count++;
+        s.totalCycles += elapsed;
+        if (elapsed < s.minCycles) {
+            s.minCycles = elapsed;
+        }
+        if (elapsed > s.maxCycles) {
+            s.maxCycles = elapsed;
+        }
+        s.histogram[31 - __builtin_clz(elapsed | 1)]++;
+    }
+
+    static const Stats& getStats(ProfileStage stage) { return stats[static_cast<int>(stage)]; }
+    static bool isEnabled();
+
+    // Print every stage with samples to Serial, then the non-empty histogram buckets
+    static void report();
+    static void reset();
+
+private:
+    // Inline so the storage only exists in builds that record into it
+    inline static Stats stats[static_cast<int>(ProfileStage::COUNT)] = {
+        {0, UINT32_MAX, 0, 0, {}}, {0, UINT32_MAX, 0, 0, {}}, {0, UINT32_MAX, 0, 0, {}},
+        {0, UINT32_MAX, 0, 0, {}}, {0, UINT32_MAX, 0, 0, {}}
+    };
+};
+
+// Times its own lifetime, see PROFILE_SCOPE
+class ProfileScope {
+private:
+    const ProfileStage stage;
+    const uint32_t started;
+
+public:
+    explicit ProfileScope(ProfileStage stage) : stage(stage), started(Profiler::cycles()) {}
+    ~ProfileScope() { Profiler::record(stage, Profiler::cycles() - started); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(ProfileStage::stage)
+#else
+#define PROFILE_SCOPE(stage) do {} while (0)
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Binary recording format shared by DataLogger and the host tools.
+//
+// File layout: an 8-byte header followed by fixed-width 15-byte records,
+// all multi-byte fields little-endian:
+//   header: "HBR" 0x00 | version u8 | record size u8 | reserved u16
+//   record: timestamp u32 | signal i16 | peak i16 | trough i16 |
+//           threshold i16 | flags u8 | bpm u16
+
+static const uint8_t RECORD_FORMAT_VERSION = 1;
+static const size_t RECORD_HEADER_SIZE = 8;
+static const size_t RECORD_SIZE = 15;
+static const uint8_t RECORD_FLAG_BEAT = 0x01;
+
+struct SampleRecord {
+    uint32_t timestamp;
+    int16_t  signal;
+    int16_t  peak;
+    int16_t  trough;
+    int16_t  threshold;
+    uint8_t  flags;
+    uint16_t bpm;
+};
+
+inline void writeLE16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+inline void writeLE32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+inline uint16_t readLE16(const uint8_t* in) {
+    return in[0] | (in[1] << 8);
+}
+
+inline uint32_t readLE32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+inline void encodeRecordHeader(uint8_t* out) {
+    memcpy(out, "HBR", 4);  // Includes the terminating zero
+    out[4] = RECORD_FORMAT_VERSION;
+    out[5] = RECORD_SIZE;
+    writeLE16(out + 6, 0);
+}
+
+// Returns false if the header isn't a version this code can read
+inline bool decodeRecordHeader(const uint8_t* in) {
+    return memcmp(in, "HBR", 4) == 0 && in[4] == RECORD_FORMAT_VERSION && in[5] == RECORD_SIZE;
+}
+
+inline void encodeRecord(const SampleRecord& record, uint8_t* out) {
+    writeLE32(out, record.timestamp);
+    writeLE16(out + 4, record.signal);
+    writeLE16(out + 6, record.peak);
+    writeLE16(out + 8, record.trough);
+    writeLE16(out + 10, record.threshold);
+    out[12] = record.flags;
+    writeLE16(out + 13, record.bpm);
+}
+
+inline void decodeRecord(const uint8_t* in, SampleRecord& record) {
+    record.timestamp = readLE32(in);
+    record.signal = (int16_t)readLE16(in + 4);
+    record.peak = (int16_t)readLE16(in + 6);
+    record.trough = (int16_t)readLE16(in + 8);
+    record.threshold = (int16_t)readLE16(in + 10);
+    record.flags = in[12];
+    record.bpm = readLE16(in + 13);
+}
+
+// Format a record as a line of the CSV schema, returns the length written
+inline int formatRecordCsv(const SampleRecord& record, char* out, size_t size) {
+    return snprintf(out, size, "%lu,%d,%d,%d,%d,%d,%u",
+                    (unsigned long)record.timestamp, record.signal, record.peak, record.trough,
+                    record.threshold, (record.flags & RECORD_FLAG_BEAT) ? 1 : 0, record.bpm);
+}
+
+#define RECORD_CSV_HEADER "timestamp,signal,peak,trough,threshold,beat_detected,bpm"
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+
+// Fixed-capacity ring buffer keeping the last N pushed values, with an
+// O(1) running sum. Storage is rounded up to a power of two so indexing
+// is a mask instead of a modulo; nothing is ever heap allocated.
+template <typename T, size_t N, typename SumT = long>
+class RingBuffer {
+    static_assert(N > 0, "RingBuffer capacity must be positive");
+
+private:
+    static constexpr size_t nextPowerOfTwo(size_t n) {
+        size_t power = 1;
+        while (power < n) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    static constexpr size_t STORAGE_SIZE = nextPowerOfTwo(N);
+    static constexpr size_t MASK = STORAGE_SIZE - 1;
+
+    T items[STORAGE_SIZE];
+    size_t head;   // Total number of pushes, newest item is at head - 1
+    size_t count;
+    SumT runningSum;
+
+public:
+    RingBuffer() : items(), head(0), count(0), runningSum(0) {}
+
+    // Append a value, evicting the oldest one once the buffer is full
+    void push(const T& value) {
+        if (count == N) {
+            runningSum -= items[(head - N) & MASK];
+        } else {
+            count++;
+        }
+        items[head & MASK] = value;
+        runningSum += value;
+        head++;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+        runningSum = 0;
+    }
+
+    // Index 0 is the oldest retained value, size() - 1 the newest
+    const T& operator[](size_t index) const { return items[(head - count + index) & MASK]; }
+    const T& newest() const { return items[(head - 1) & MASK]; }
+    const T& oldest() const { return items[(head - count) & MASK]; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    SumT sum() const { return runningSum; }
+    static constexpr size_t capacity() { return N; }
+};
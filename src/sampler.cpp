@@ -0,0 +1,108 @@
+#include "sampler.hpp"
+
+Sampler::Sampler(int pin) :
+    inputPin(pin),
+    sampleRate(DEFAULT_SAMPLE_RATE),
+    running(false),
+    droppedSamples(0),
+    debugOutput(false) {
+#ifdef ARDUINO_ARCH_ESP32
+  timer = nullptr;
+#endif
+}
+
+void Sampler::init() {
+  pinMode(inputPin, INPUT);
+
+#ifdef ARDUINO_ARCH_ESP32
+  esp_timer_create_args_t args = {};
+  args.callback = &Sampler::onTimer;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "sampler";
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    timer = nullptr;
+    if (debugOutput && Serial) {
+      Serial.println("Sampler timer creation failed!");
+    }
+  }
+#endif
+}
+
+void Sampler::start() {
+  if (running) {
+    stop();
+  }
+
+#ifdef ARDUINO_ARCH_ESP32
+  if (!timer || esp_timer_start_periodic(timer, 1000000UL / sampleRate) != ESP_OK) {
+    if (debugOutput && Serial) {
+      Serial.println("Sampler timer start failed!");
+    }
+    return;
+  }
+#endif
+  running = true;
+
+  if (debugOutput && Serial) {
+    Serial.printf("Sampler running at %d Hz\n", sampleRate);
+  }
+}
+
+void Sampler::stop() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (timer) {
+    esp_timer_stop(timer);
+  }
+#endif
+  running = false;
+}
+
+bool Sampler::isRunning() const {
+  return running;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void Sampler::onTimer(void* arg) {
+  static_cast<Sampler*>(arg)->captureSample();
+}
+#endif
+
+void Sampler::captureSample() {
+  Sample sample;
+  sample.timestamp = millis();
+  sample.value = analogRead(inputPin);
+  if (!queue.push(sample)) {
+    droppedSamples = droppedSamples + 1;
+  }
+}
+
+size_t Sampler::read(Sample* out, size_t maxSamples) {
+  return queue.popBatch(out, maxSamples);
+}
+
+size_t Sampler::getQueuedSamples() const {
+  return queue.size();
+}
+
+uint32_t Sampler::getDroppedSamples() const {
+  return droppedSamples;
+}
+
+// Sampling rate configuration methods
+void Sampler::setSampleRate(int rate) {
+  sampleRate = max(SAMPLE_RATE_MIN, min(SAMPLE_RATE_MAX, rate));
+}
+
+int Sampler::getSampleRate() const {
+  return sampleRate;
+}
+
+// Debug output control
+bool Sampler::getDebugOutput() const {
+  return debugOutput;
+}
+
+void Sampler::setDebugOutput(bool enable) {
+  debugOutput = enable;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Arduino.h>
+#include "acquisition_source.hpp"
+#include "spsc_queue.hpp"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_timer.h>
+#endif
+
+// Fixed ADC sampling rate in Hz (250-1000), 0 samples once per acquisition cycle instead
+#ifndef SAMPLE_RATE_HZ
+#define SAMPLE_RATE_HZ 500
+#endif
+
+// Fixed-rate ADC sampling driven by a periodic esp_timer, one blocking
+// analogRead() per sample. Samples are captured independently of loop()
+// timing and queued in a lock-free ring buffer that Sensor drains in batches.
+class Sampler : public AcquisitionSource {
+private:
+    static const int DEFAULT_SAMPLE_RATE = 500;  // Hz
+    static const int SAMPLE_RATE_MIN = 250;
+    static const int SAMPLE_RATE_MAX = 1000;
+    static const size_t QUEUE_SIZE = 512;        // ~0.5 s of headroom at 1 kHz
+
+    const int inputPin;
+    int sampleRate;
+    bool running;
+    volatile uint32_t droppedSamples;  // Samples lost because the consumer fell behind
+    SpscQueue<Sample, QUEUE_SIZE> queue;
+    bool debugOutput;
+
+#ifdef ARDUINO_ARCH_ESP32
+    esp_timer_handle_t timer;
+    static void onTimer(void* arg);
+#endif
+
+public:
+    Sampler(int pin);
+    void init() override;
+    void start() override;
+    void stop() override;
+    bool isRunning() const override;
+
+    // Timer callback body; host replays call it directly to inject samples
+    void captureSample();
+
+    // Consumer side - copy up to maxSamples queued samples, returns count
+    size_t read(Sample* out, size_t maxSamples) override;
+    size_t getQueuedSamples() const override;
+    uint32_t getDroppedSamples() const override;
+
+    // Sampling rate configuration (takes effect on next start())
+    int  getSampleRate() const override;
+    void setSampleRate(int rate) override;
+    static int getSampleRateMin() { return SAMPLE_RATE_MIN; }
+    static int getSampleRateMax() { return SAMPLE_RATE_MAX; }
+
+    // Debug output control
+    bool getDebugOutput() const;
+    void setDebugOutput(bool enable);
+};
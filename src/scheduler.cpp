@@ -0,0 +1,179 @@
+#include "scheduler.hpp"
+
+Scheduler::Scheduler(const char* name) :
+    name(name),
+    jobs(),
+    jobCount(0),
+    statsStarted(0),
+    sleptMicros(0),
+    debugOutput(false) {
+}
+
+int Scheduler::addJob(const char* jobName, JobFunction function, uint32_t periodMs, uint32_t deadlineMs) {
+  if (jobCount >= MAX_JOBS || !function) {
+    return -1;
+  }
+
+  periodMs = max(PERIOD_MIN_MS, min(PERIOD_MAX_MS, periodMs));
+  deadlineMs = (deadlineMs == 0) ? periodMs : min(deadlineMs, periodMs);
+
+  Job& job = jobs[jobCount];
+  job.name = jobName;
+  job.function = function;
+  job.periodMicros = periodMs * 1000;
+  job.deadlineMicros = deadlineMs * 1000;
+  job.nextRelease = micros();
+  job.stats = JobStats();
+  return jobCount++;
+}
+
+void Scheduler::start() {
+  uint32_t now = micros();
+  for (size_t i = 0; i < jobCount; i++) {
+    jobs[i].nextRelease = now;
+  }
+  statsStarted = now;
+  sleptMicros = 0;
+}
+
+uint32_t Scheduler::runDue() {
+  for (;;) {
+    // Earliest released job first, registration order breaks ties
+    uint32_t now = micros();
+    Job* due = nullptr;
+    for (size_t i = 0; i < jobCount; i++) {
+      if ((int32_t)(now - jobs[i].nextRelease) >= 0 &&
+          (!due || (int32_t)(jobs[i].nextRelease - due->nextRelease) < 0)) {
+        due = &jobs[i];
+      }
+    }
+    if (!due) {
+      break;
+    }
+    runJob(*due);
+  }
+
+  uint32_t now = micros();
+  uint32_t wait = UINT32_MAX;
+  for (size_t i = 0; i < jobCount; i++) {
+    uint32_t untilRelease = jobs[i].nextRelease - now;
+    if ((int32_t)untilRelease <= 0) {
+      return 0;
+    }
+    wait = min(wait, untilRelease);
+  }
+  return wait;
+}
+
+void Scheduler::runJob(Job& job) {
+  uint32_t started = micros();
+  job.function();
+  uint32_t finished = micros();
+
+  JobStats& stats = job.stats;
+  uint32_t lateness = started - job.nextRelease;
+  stats.runs++;
+  stats.lastLatenessMicros = lateness;
+  stats.totalLatenessMicros += lateness;
+  if (stats.runs == 1 || lateness < stats.minLatenessMicros) {
+    stats.minLatenessMicros = lateness;
+  }
+  if (lateness > stats.maxLatenessMicros) {
+    stats.maxLatenessMicros = lateness;
+  }
+  if (finished - started > stats.maxRunMicros) {
+    stats.maxRunMicros = finished - started;
+  }
+  if (finished - job.nextRelease > job.deadlineMicros) {
+    stats.deadlineMisses++;
+    if (debugOutput && Serial) {
+      Serial.printf("%s: %s missed its deadline by %u us\n", name, job.name,
+                    (unsigned)(finished - job.nextRelease - job.deadlineMicros));
+    }
+  }
+
+  // Next release stays on the grid; periods that already passed are skipped, not run back to back
+  job.nextRelease += job.periodMicros;
+  uint32_t behind = finished - job.nextRelease;
+  if ((int32_t)behind >= 0 && behind >= job.periodMicros) {
+    uint32_t skipped = behind / job.periodMicros;
+    stats.skippedReleases += skipped;
+    job.nextRelease += skipped * job.periodMicros;
+  }
+}
+
+void Scheduler::run() {
+  start();
+  for (;;) {
+    uint32_t wait = runDue();
+    if (wait > 0) {
+      // Sleep in whole ticks, rounded up so we never wake before the release
+      uint32_t before = micros();
+      delay((wait + 999) / 1000);
+      sleptMicros += micros() - before;
+    }
+  }
+}
+
+size_t Scheduler::getJobCount() const {
+  return jobCount;
+}
+
+const char* Scheduler::getJobName(size_t job) const {
+  return job < jobCount ? jobs[job].name : nullptr;
+}
+
+const Scheduler::JobStats& Scheduler::getJobStats(size_t job) const {
+  static const JobStats none = JobStats();
+  return job < jobCount ? jobs[job].stats : none;
+}
+
+uint32_t Scheduler::getIdlePercent() const {
+  uint32_t elapsed = micros() - statsStarted;
+  return elapsed ? (uint32_t)((uint64_t)sleptMicros * 100 / elapsed) : 0;
+}
+
+void Scheduler::report() const {
+  if (!Serial) {
+    return;
+  }
+  Serial.printf("Scheduler %s: %u%% idle\n", name, (unsigned)getIdlePercent());
+  Serial.printf("%-12s %7s %8s %7s %7s %9s %9s %9s %9s\n",
+                "job", "period", "runs", "missed", "skipped", "mean late", "max late", "jitter", "max run");
+  for (size_t i = 0; i < jobCount; i++) {
+    const Job& job = jobs[i];
+    const JobStats& stats = job.stats;
+    uint32_t meanLateness = stats.runs ? stats.totalLatenessMicros / stats.runs : 0;
+    uint32_t jitter = stats.runs ? stats.maxLatenessMicros - stats.minLatenessMicros : 0;
+    Serial.printf("%-12s %5ums %8u %7u %7u %7uus %7uus %7uus %7uus\n", job.name,
+                  (unsigned)(job.periodMicros / 1000), (unsigned)stats.runs,
+                  (unsigned)stats.deadlineMisses, (unsigned)stats.skippedReleases,
+                  (unsigned)meanLateness, (unsigned)stats.maxLatenessMicros, (unsigned)jitter,
+                  (unsigned)stats.maxRunMicros);
+  }
+}
+
+void Scheduler::resetStats() {
+  for (size_t i = 0; i < jobCount; i++) {
+    jobs[i].stats = JobStats();
+  }
+  statsStarted = micros();
+  sleptMicros = 0;
+}
+
+uint32_t Scheduler::getPeriodMin() {
+  return PERIOD_MIN_MS;
+}
+
+uint32_t Scheduler::getPeriodMax() {
+  return PERIOD_MAX_MS;
+}
+
+// Debug output control
+bool Scheduler::getDebugOutput() const {
+  return debugOutput;
+}
+
+void Scheduler::setDebugOutput(bool enable) {
+  debugOutput = enable;
+}
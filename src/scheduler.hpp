@@ -0,0 +1,81 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Deadline-based cooperative scheduler for the jobs of one task.
+// Each job is released every period on a fixed grid (release += period, so
+// cadences don't drift with workload) and should finish within its deadline.
+// run() executes due jobs in release order and sleeps until the next
+// release instead of a fixed delay. Per job it counts deadline misses and
+// releases skipped while overrunning, and measures start lateness and its
+// jitter (max - min lateness).
+class Scheduler {
+public:
+    typedef void (*JobFunction)();
+
+    struct JobStats {
+        uint32_t runs;
+        uint32_t deadlineMisses;       // Finished later than release + deadline
+        uint32_t skippedReleases;      // Whole periods lost to overruns
+        uint32_t lastLatenessMicros;   // Start time minus release time
+        uint32_t minLatenessMicros;    // Valid once runs > 0
+        uint32_t maxLatenessMicros;
+        uint64_t totalLatenessMicros;
+        uint32_t maxRunMicros;
+    };
+
+private:
+    static const size_t MAX_JOBS = 8;
+    static const uint32_t PERIOD_MIN_MS = 1;
+    static const uint32_t PERIOD_MAX_MS = 60000;
+
+    struct Job {
+        const char* name;
+        JobFunction function;
+        uint32_t periodMicros;
+        uint32_t deadlineMicros;
+        uint32_t nextRelease;  // micros() clock
+        JobStats stats;
+    };
+
+    const char* const name;
+    Job jobs[MAX_JOBS];
+    size_t jobCount;
+    uint32_t statsStarted;
+    uint32_t sleptMicros;
+    bool debugOutput;
+
+    void runJob(Job& job);
+
+public:
+    explicit Scheduler(const char* name);
+
+    // Register a job before start(); deadline 0 means the end of the period.
+    // Returns the job index, -1 if the table is full
+    int addJob(const char* jobName, JobFunction function, uint32_t periodMs, uint32_t deadlineMs = 0);
+
+    // Release every job now
+    void start();
+
+    // Run every job that is due, returns microseconds until the next release
+    uint32_t runDue();
+
+    // start(), then runDue() and sleep until the next release, forever
+    void run();
+
+    size_t getJobCount() const;
+    const char* getJobName(size_t job) const;
+    const JobStats& getJobStats(size_t job) const;  // Zeroed stats for an unknown job
+    uint32_t getIdlePercent() const;  // Share of time spent sleeping since the stats were reset
+
+    // Print per-job statistics to Serial
+    void report() const;
+    void resetStats();
+
+    static uint32_t getPeriodMin();
+    static uint32_t getPeriodMax();
+
+    // Debug output control
+    bool getDebugOutput() const;
+    void setDebugOutput(bool enable);
+};
@@ -1,22 +1,33 @@
 #include "sensor.hpp"
+#include "trace.hpp"
 #include <SPIFFS.h>
 
 Sensor::Sensor(DataLogger& logger) :
     sensorSignal(0),
     lastSignal(0),
-    thresholdOffset(DEFAULT_THRESHOLD_OFFSET),  // Default threshold value
-    beatDetected(false),
     lastBeatTime(0),
     bpm(0),
     peakValue(0),
     troughValue(4095),
     effectiveThreshold(0),
+    beatDetected(false),
     pulseDetected(false),
+    batchMin(0),
+    batchMax(0),
+    lastDecayTime(0),
+    previousBeatSeen(false),
+    dataLogger(logger),
+    sampler(nullptr),
+    bandPassFilter(BAND_PASS_STAGES),
+    filterEnabled(false),
+    filterPrimed(false),
+    edgeArmed(true),
+    telemetry(nullptr),
     peakDecayRate(DEFAULT_PEAK_DECAY_RATE),
     troughDecayRate(DEFAULT_TROUGH_DECAY_RATE),
     bpmOffset(DEFAULT_BPM_OFFSET),
-    debugOutput(false),
-    dataLogger(logger) {
+    thresholdOffset(DEFAULT_THRESHOLD_OFFSET),  // Default threshold value
+    debugOutput(false) {
 }
 
 void Sensor::init() {
@@ -25,14 +36,58 @@ void Sensor::init() {
   if (Serial) {
     Serial.println("Pulse sensor initialized on GPIO 34");
   }
-}void Sensor::update() {
-  sensorSignal = analogRead(PULSE_INPUT);  // Read raw sensor signal
-  
-  // Maintain signal history for console smoothing (keep only last 3)
-  signalHistory.push_back(sensorSignal);
-  if (signalHistory.size() > 3) {
-    signalHistory.erase(signalHistory.begin());
+}
+
+void Sensor::update() {
+  if (!sampler || !sampler->isRunning()) {
+    processSample(analogRead(PULSE_INPUT), millis());  // Read raw sensor signal
+    batchMin = batchMax = sensorSignal;
+    return;
+  }
+
+  // Drain everything captured since the last call; a beat anywhere in
+  // the batch stays reported until the next update()
+  bool beatInBatch = false;
+  // The range starts at the previous sample, so consecutive batches join up on the graph
+  int low = sensorSignal;
+  int high = sensorSignal;
+  AcquisitionSource::Sample batch[SAMPLE_BATCH_SIZE];
+  size_t count;
+  while ((count = sampler->read(batch, SAMPLE_BATCH_SIZE)) > 0) {
+    for (size_t i = 0; i < count; i++) {
+      processSample(batch[i].value, batch[i].timestamp);
+      beatInBatch = beatInBatch || beatDetected;
+      low = min(low, sensorSignal);
+      high = max(high, sensorSignal);
+    }
   }
+  beatDetected = beatInBatch;
+  batchMin = low;
+  batchMax = high;
+}
+
+void Sensor::processSample(int signal, unsigned long timestamp) {
+  // Peak and trough are in the units of the other path after a toggle,
+  // let them restart from the next sample
+  if (filterEnabled != filterPrimed) {
+    peakValue = 0;
+    troughValue = ADC_MAX;
+    edgeArmed = true;
+  }
+  if (filterEnabled) {
+    // Start from the current level so enabling the filter doesn't ring
+    if (!filterPrimed) {
+      bandPassFilter.prime(signal);
+      filterPrimed = true;
+    }
+    signal = max(0, min(ADC_MAX, bandPassFilter.process(signal) + FILTER_OUTPUT_OFFSET));
+  } else {
+    filterPrimed = false;
+  }
+  sensorSignal = signal;
+  
+  // Maintain signal history for console smoothing (keeps only last 3)
+  signalHistory.push(sensorSignal);
   
   beatDetected = false;
 
@@ -52,26 +107,41 @@ void Sensor::init() {
   effectiveThreshold = autoThreshold + thresholdOffset;
 
   // Detect rising edge (beat)
-  if (sensorSignal > effectiveThreshold && lastSignal <= effectiveThreshold) {
-    unsigned long now = millis();
+  bool risingEdge = sensorSignal > effectiveThreshold && lastSignal <= effectiveThreshold;
+  if (filterPrimed) {
+    int amplitude = peakValue - troughValue;
+    if (sensorSignal < effectiveThreshold - amplitude / FILTER_HYSTERESIS_DIVISOR) {
+      edgeArmed = true;
+    }
+    risingEdge = edgeArmed && sensorSignal > effectiveThreshold && amplitude >= FILTER_MIN_AMPLITUDE;
+  }
+  if (risingEdge) {
+    unsigned long now = timestamp;
     unsigned long timeSinceLastBeat = now - lastBeatTime;
 
     // Valid beat if at least 300ms since last beat (max 200 BPM)
     if (timeSinceLastBeat > 300) {
       beatDetected = true;
-      lastBeatTime = now;
+      TRACE_EVENT(BEAT, previousBeatSeen ? 60000 / timeSinceLastBeat : 0);
 
-      // Store beat timestamp (keep only last 11 for 10 intervals)
-      beatTimestamps.push_back(now);
-      if (beatTimestamps.size() > 11) {
-        beatTimestamps.erase(beatTimestamps.begin());
+      // Store BPM of this interval (keeps only last 10 intervals)
+      if (previousBeatSeen && timeSinceLastBeat > 0) {
+        intervalBpmHistory.push(60000 / timeSinceLastBeat);
       }
+      previousBeatSeen = true;
+      lastBeatTime = now;
+      edgeArmed = false;
     }
   }
 
-  // Decay peaks and troughs slowly for auto-adjustment
-  peakValue -= peakDecayRate;
-  troughValue += troughDecayRate;
+  // Decay peaks and troughs slowly for auto-adjustment. Decay rates are
+  // per loop iteration, so fixed-rate sampling applies them at the same
+  // 20 ms cadence rather than on every sample.
+  if (!sampler || timestamp - lastDecayTime >= DECAY_INTERVAL_MS) {
+    peakValue -= peakDecayRate;
+    troughValue += troughDecayRate;
+    lastDecayTime = timestamp;
+  }
   if (peakValue < sensorSignal) peakValue = sensorSignal;
   if (troughValue > sensorSignal) troughValue = sensorSignal;
 
@@ -97,30 +167,29 @@ void Sensor::init() {
     lastDebugTime = millis();
   }
 
+  if (telemetry && telemetry->isStreaming()) {
+    SampleRecord record;
+    record.timestamp = timestamp;
+    record.signal = sensorSignal;
+    record.peak = peakValue;
+    record.trough = troughValue;
+    record.threshold = effectiveThreshold;
+    record.flags = beatDetected ? RECORD_FLAG_BEAT : 0;
+    record.bpm = getBPM();
+    telemetry->publish(record);
+  }
+
   lastSignal = sensorSignal;
 }
 
 int Sensor::getBPM() {
-  // Need at least 2 beats to calculate BPM
-  if (beatTimestamps.size() < 2) {
+  // Need at least 2 beats (one interval) to calculate BPM
+  if (intervalBpmHistory.empty()) {
     return 0;
   }
   
-  // Calculate BPM for each interval and average them
-  int numIntervals = beatTimestamps.size() - 1;
-  int validBpmCount = 0;
-  int bpmSum = 0;
-  
-  for (int i = 0; i < numIntervals; i++) {
-    unsigned long interval = beatTimestamps[i + 1] - beatTimestamps[i];
-    if (interval > 0) {
-      int bpm = 60000 / interval;
-      bpmSum += bpm;
-      validBpmCount++;
-    }
-  }
-  
-  int averageBPM = bpmSum / validBpmCount;
+  // Average the per-interval BPM values
+  int averageBPM = intervalBpmHistory.sum() / (long)intervalBpmHistory.size();
   
   // Apply BPM offset
   return max(0, averageBPM + bpmOffset);
@@ -139,12 +208,15 @@ int Sensor::getSmoothedSignal() {
     return sensorSignal;
   }
   
-  int sum = 0;
-  for (int signal : signalHistory) {
-    sum += signal;
-  }
-  
-  return sum / signalHistory.size();
+  return signalHistory.sum() / (long)signalHistory.size();
+}
+
+int Sensor::getSignalMin() const {
+  return batchMin;
+}
+
+int Sensor::getSignalMax() const {
+  return batchMax;
 }
 
 int Sensor::getPeakValue() const {
@@ -195,6 +267,33 @@ int Sensor::getThresholdOffset() const {
   return thresholdOffset;
 }
 
+// Sampling mode configuration methods
+void Sensor::setSampler(AcquisitionSource* source) {
+  sampler = source;
+}
+
+AcquisitionSource* Sensor::getSampler() const {
+  return sampler;
+}
+
+// Filter configuration methods
+void Sensor::setFilterEnabled(bool enable) {
+  filterEnabled = enable;
+}
+
+bool Sensor::isFilterEnabled() const {
+  return filterEnabled;
+}
+
+// Live streaming configuration methods
+void Sensor::setTelemetry(Telemetry* stream) {
+  telemetry = stream;
+}
+
+Telemetry* Sensor::getTelemetry() const {
+  return telemetry;
+}
+
 // Debug output configuration methods
 void Sensor::setDebugOutput(bool enable) {
   debugOutput = enable;
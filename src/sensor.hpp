@@ -1,8 +1,12 @@
 #pragma once
 
 #include <Arduino.h>
-#include <vector>
+#include "biquad_filter.hpp"
 #include "data_logger.hpp"
+#include "ring_buffer.hpp"
+#include "acquisition_source.hpp"
+#include "sampler.hpp"
+#include "telemetry.hpp"
 
 class Sensor {
 private:
@@ -19,15 +23,51 @@ private:
     int effectiveThreshold;
     bool beatDetected;
     bool pulseDetected;
+    int batchMin;   // Signal range of the samples processed by the last update()
+    int batchMax;
+    unsigned long lastDecayTime;
     
-    // Store last 11 beat timestamps for 10 interval BPM calculation
-    std::vector<unsigned long> beatTimestamps;
+    // BPM of the last 10 beat-to-beat intervals (running sum gives the average)
+    RingBuffer<int, 10> intervalBpmHistory;
+    bool previousBeatSeen;
     
     // Signal smoothing for console output over 3 values
-    std::vector<int> signalHistory;
+    RingBuffer<int, 3> signalHistory;
     
     // Data logger reference
     DataLogger& dataLogger;
+
+    // Fixed-rate sample source (nullptr = read the ADC once per update())
+    AcquisitionSource* sampler;
+    static const size_t SAMPLE_BATCH_SIZE = 32;
+    static const unsigned long DECAY_INTERVAL_MS = 20;  // Peak/trough decay cadence in sampler mode
+
+    // Band-pass stage ahead of peak/trough tracking (0.5-5 Hz, 30-300 BPM).
+    // Coefficients are fixed at compile time for SAMPLE_RATE_HZ, or the
+    // 100 Hz acquisition cycle when sampling without the Sampler.
+    static constexpr double FILTER_SAMPLE_RATE_HZ = SAMPLE_RATE_HZ > 0 ? SAMPLE_RATE_HZ : 100;
+    static constexpr double FILTER_LOW_CUTOFF_HZ = 0.5;
+    static constexpr double FILTER_HIGH_CUTOFF_HZ = 5.0;
+    static const int FILTER_OUTPUT_OFFSET = 2048;  // Re-centre the zero-mean output in the ADC range
+    static const int ADC_MAX = 4095;
+    static constexpr BiquadCoefficients BAND_PASS_STAGES[2] = {
+        butterworthHighPass(FILTER_LOW_CUTOFF_HZ, FILTER_SAMPLE_RATE_HZ),
+        butterworthLowPass(FILTER_HIGH_CUTOFF_HZ, FILTER_SAMPLE_RATE_HZ)
+    };
+    BiquadCascade<2> bandPassFilter;
+    volatile bool filterEnabled;
+    bool filterPrimed;
+
+    // The filtered signal has no DC level, so peak and trough can close in on
+    // a nearly flat signal. Filtered beats need at least this peak-to-trough
+    // swing, and the edge only re-arms once the signal has fallen back below
+    // the threshold by 1/FILTER_HYSTERESIS_DIVISOR of the swing.
+    static const int FILTER_MIN_AMPLITUDE = 40;
+    static const int FILTER_HYSTERESIS_DIVISOR = 4;
+    bool edgeArmed;
+
+    // Live per-sample stream (nullptr = disabled)
+    Telemetry* telemetry;
     
     // Configuration parameters
     int peakDecayRate;
@@ -56,10 +96,13 @@ public:
     Sensor(DataLogger& logger);
     void init();
     void update();
+    void processSample(int signal, unsigned long timestamp);  // Run detection on one sample (timestamp in ms)
     int  getBPM();                // Get current BPM
     bool isBeatDetected();        // Check if a heartbeat was just detected
     int  getSignal();             // Get raw sensor signal value
     int  getSmoothedSignal();     // Get smoothed signal value for console output
+    int  getSignalMin() const;    // Lowest signal processed by the last update()
+    int  getSignalMax() const;    // Highest signal processed by the last update()
     int  getPeakValue() const;    // Get current peak value
     int  getTroughValue() const;  // Get current trough value
     int  getEffectiveThreshold() const; // Get current effective threshold
@@ -77,6 +120,22 @@ public:
     int  getTroughDecayRate() const;
     void setTroughDecayRate(int rate);
 
+    // Hardware configuration
+    static int getPulseInputPin() { return PULSE_INPUT; }
+
+    // Sampling mode - drain a background AcquisitionSource (timer, DMA)
+    // instead of polling the ADC
+    void setSampler(AcquisitionSource* source);
+    AcquisitionSource* getSampler() const;
+
+    // Band-pass filtering of the raw signal (off by default)
+    void setFilterEnabled(bool enable);
+    bool isFilterEnabled() const;
+
+    // Live streaming - every processed sample is published to the telemetry queue
+    void setTelemetry(Telemetry* stream);
+    Telemetry* getTelemetry() const;
+
     // Configuration limits
     static int getBpmOffsetMin() { return BPM_OFFSET_MIN; }
     static int getBpmOffsetMax() { return BPM_OFFSET_MAX; }
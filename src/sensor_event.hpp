@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include "spsc_queue.hpp"
+
+// Snapshot of the detector state after one acquisition cycle, passed from
+// the acquisition task to the UI/storage task
+struct SensorEvent {
+    uint32_t timestamp;   // millis() of the newest processed sample
+    int16_t  signal;
+    int16_t  signalMin;   // Range of all samples processed this cycle
+    int16_t  signalMax;
+    int16_t  peak;
+    int16_t  trough;
+    int16_t  threshold;
+    uint16_t bpm;
+    bool     beatDetected;
+};
+
+// ~2.5 s of backlog at the 10 ms acquisition period
+typedef SpscQueue<SensorEvent, 256> SensorEventQueue;
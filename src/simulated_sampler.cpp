@@ -0,0 +1,55 @@
+#include "simulated_sampler.hpp"
+
+SimulatedSampler::SimulatedSampler(int pin) :
+    inputPin(pin),
+    noiseAmplitude(0),
+    noiseState(1),
+    burstLength(0) {
+}
+
+void SimulatedSampler::init() {
+  pinMode(inputPin, INPUT);
+}
+
+void SimulatedSampler::start() {
+  beginConversions();
+  burstLength = 0;
+  noiseState = 1;
+  running = true;
+
+  if (debugOutput && Serial) {
+    Serial.printf("Simulated sampler running at %d Hz, %d conversions per sample\n",
+                  sampleRate, oversampling);
+  }
+}
+
+void SimulatedSampler::stop() {
+  running = false;
+}
+
+void SimulatedSampler::captureConversion() {
+  if (!running) {
+    return;
+  }
+
+  int value = analogRead(inputPin);
+  if (noiseAmplitude > 0) {
+    // Deterministic LCG so replays stay reproducible
+    noiseState = noiseState * 1664525 + 1013904223;
+    value += (int)((noiseState >> 16) % (2 * noiseAmplitude + 1)) - noiseAmplitude;
+  }
+  burst[burstLength++] = max(0, min(4095, value));
+
+  if (burstLength == BURST_SIZE) {
+    pushConversions(burst, burstLength);
+    burstLength = 0;
+  }
+}
+
+void SimulatedSampler::setNoise(int amplitude) {
+  noiseAmplitude = max(0, min(2047, amplitude));
+}
+
+int SimulatedSampler::getNoise() const {
+  return noiseAmplitude;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+#include "oversampling_source.hpp"
+
+// Stand-in for DmaSampler without ADC hardware: each captureConversion()
+// converts the pin's analogRead() level plus optional uniform noise and
+// feeds it through the same decimation and queue. Host drivers call it at
+// getConversionRate() on the simulated clock.
+class SimulatedSampler : public OversamplingSource {
+private:
+    static const size_t BURST_SIZE = 32;  // Conversions delivered together, like a DMA frame
+
+    const int inputPin;
+    int noiseAmplitude;
+    uint32_t noiseState;
+    uint16_t burst[BURST_SIZE];
+    size_t burstLength;
+
+public:
+    SimulatedSampler(int pin);
+    void init() override;
+    void start() override;
+    void stop() override;
+
+    void captureConversion();
+
+    // Peak amplitude of the noise added to every conversion (ADC counts)
+    void setNoise(int amplitude);
+    int getNoise() const;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+
+// Minimum and maximum of the last N pushed values in O(1) amortized time
+// per push, using two monotonic deques (ascending minima and descending
+// maxima). Each deque holds window positions whose values can still become
+// the extreme; dominated entries are discarded on push. Storage is fixed,
+// no heap use.
+template <typename T, size_t N>
+class SlidingMinMax {
+    static_assert(N > 0, "SlidingMinMax window must be positive");
+
+private:
+    static constexpr size_t nextPowerOfTwo(size_t n) {
+        size_t power = 1;
+        while (power < n) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    static constexpr size_t STORAGE_SIZE = nextPowerOfTwo(N);
+    static constexpr size_t MASK = STORAGE_SIZE - 1;
+
+    struct Entry {
+        size_t position;  // Push count when the value entered
+        T value;
+    };
+
+    // Front (oldest) at head, back at tail - 1; values increase towards the
+    // back in minQueue and decrease in maxQueue
+    Entry minQueue[STORAGE_SIZE];
+    Entry maxQueue[STORAGE_SIZE];
+    size_t minHead, minTail;
+    size_t maxHead, maxTail;
+    size_t pushes;
+
+public:
+    SlidingMinMax() : minHead(0), minTail(0), maxHead(0), maxTail(0), pushes(0) {}
+
+    void push(const T& value) {
+        // Drop the entry leaving the window first, so a deque never holds more than N
+        if (minTail != minHead && minQueue[minHead & MASK].position + N <= pushes) {
+            minHead++;
+        }
+        if (maxTail != maxHead && maxQueue[maxHead & MASK].position + N <= pushes) {
+            maxHead++;
+        }
+
+        while (minTail != minHead && !(minQueue[(minTail - 1) & MASK].value < value)) {
+            minTail--;
+        }
+        minQueue[minTail++ & MASK] = {pushes, value};
+
+        while (maxTail != maxHead && !(value < maxQueue[(maxTail - 1) & MASK].value)) {
+            maxTail--;
+        }
+        maxQueue[maxTail++ & MASK] = {pushes, value};
+        pushes++;
+    }
+
+    void clear() {
+        minHead = minTail = maxHead = maxTail = 0;
+        pushes = 0;
+    }
+
+    // Only valid when !empty()
+    const T& min() const { return minQueue[minHead & MASK].value; }
+    const T& max() const { return maxQueue[maxHead & MASK].value; }
+
+    bool empty() const { return pushes == 0; }
+    static constexpr size_t window() { return N; }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free latest-value mailbox (triple buffer) for one producer and one
+// consumer. The producer fills writeSlot() and publishes it; the consumer
+// takes the newest published value. Neither side ever waits - a value the
+// consumer didn't get to in time is simply replaced.
+template <typename T>
+class SnapshotMailbox {
+private:
+    static const uint8_t INDEX_MASK = 0x03;
+    static const uint8_t FRESH = 0x04;  // Middle slot holds an unread value
+
+    T slots[3];
+    std::atomic<uint8_t> middle;  // Slot index exchanged between the two sides
+    uint8_t writeIndex;           // Owned by the producer
+    uint8_t readIndex;            // Owned by the consumer
+
+public:
+    SnapshotMailbox() : middle(1), writeIndex(0), readIndex(2) {}
+
+    // Producer side - fill this slot, then publish()
+    T& writeSlot() { return slots[writeIndex]; }
+
+    // Producer side - returns false if an unread value was replaced
+    bool publish() {
+        uint8_t previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+        return (previous & FRESH) == 0;
+    }
+
+    // Consumer side - returns false if nothing new was published since the last take()
+    bool take() {
+        if ((middle.load(std::memory_order_acquire) & FRESH) == 0) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Consumer side - value obtained by the last successful take()
+    const T& readSlot() const { return slots[readIndex]; }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+// Lock-free single-producer/single-consumer queue with fixed capacity.
+// Capacity must be a power of two; one producer context may push() while
+// one consumer context pops, without locks or heap allocation.
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+private:
+    static const size_t MASK = N - 1;
+
+    T items[N];
+    std::atomic<size_t> head;  // Next slot to write (owned by producer)
+    std::atomic<size_t> tail;  // Next slot to read (owned by consumer)
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // Producer side - returns false if the queue is full
+    bool push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        items[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - returns false if the queue is empty
+    bool pop(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side - pops up to maxItems at once, returns count popped
+    size_t popBatch(T* out, size_t maxItems) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - t;
+        size_t count = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = items[(t + i) & MASK];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+};
@@ -0,0 +1,97 @@
+#include "telemetry.hpp"
+
+Telemetry::Telemetry() :
+    streaming(false),
+    droppedSamples(0),
+    reportedDrops(0),
+    sequence(0),
+    framesSent(0),
+    lastFrameTime(0),
+    debugOutput(false) {
+}
+
+void Telemetry::start() {
+  // Discard samples left over from a previous session before enabling the producer
+  SampleRecord discard;
+  while (queue.pop(discard)) {
+  }
+  reportedDrops = droppedSamples;
+  lastFrameTime = millis();
+  streaming = true;
+
+  if (debugOutput && Serial) {
+    Serial.println("Telemetry streaming started");
+  }
+}
+
+void Telemetry::stop() {
+  streaming = false;
+
+  if (debugOutput && Serial) {
+    Serial.printf("Telemetry streaming stopped (%u frames, %u samples dropped)\n",
+                  (unsigned)framesSent, (unsigned)droppedSamples);
+  }
+}
+
+bool Telemetry::isStreaming() const {
+  return streaming;
+}
+
+void Telemetry::publish(const SampleRecord& record) {
+  if (!streaming) {
+    return;
+  }
+  if (!queue.push(record)) {
+    droppedSamples = droppedSamples + 1;
+  }
+}
+
+void Telemetry::service() {
+  if (!streaming || !Serial) {
+    return;
+  }
+
+  // Full frames go out as soon as they are complete, a partial frame only
+  // once it has waited FLUSH_INTERVAL_MS so the host still sees a live feed
+  SampleRecord records[RECORDS_PER_FRAME];
+  while (Serial.availableForWrite() >= (int)FRAME_MAX_SIZE) {
+    size_t queued = queue.size();
+    if (queued == 0 || (queued < RECORDS_PER_FRAME && millis() - lastFrameTime < FLUSH_INTERVAL_MS)) {
+      return;
+    }
+    sendFrame(records, queue.popBatch(records, RECORDS_PER_FRAME));
+  }
+}
+
+void Telemetry::sendFrame(const SampleRecord* records, size_t count) {
+  // Payload: samples dropped since the previous frame, then the records
+  uint8_t payload[2 + RECORDS_PER_FRAME * RECORD_SIZE];
+  uint32_t drops = droppedSamples;
+  writeLE16(payload, (uint16_t)min(drops - reportedDrops, (uint32_t)0xFFFF));
+  reportedDrops = drops;
+  for (size_t i = 0; i < count; i++) {
+    encodeRecord(records[i], payload + 2 + i * RECORD_SIZE);
+  }
+
+  size_t frameSize = encodeFrame(FRAME_TELEMETRY, sequence++, payload, 2 + count * RECORD_SIZE, frameBuffer);
+  Serial.write(frameBuffer, frameSize);
+  framesSent++;
+  lastFrameTime = millis();
+}
+
+uint32_t Telemetry::getFramesSent() const {
+  return framesSent;
+}
+
+uint32_t Telemetry::getDroppedSamples() const {
+  return droppedSamples;
+}
+
+// Debug output control
+bool Telemetry::getDebugOutput() const {
+  return debugOutput;
+}
+
+void Telemetry::setDebugOutput(bool enable) {
+  debugOutput = enable;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include "frame_codec.hpp"
+#include "record_format.hpp"
+#include "spsc_queue.hpp"
+
+// Live streaming of every processed sample over Serial, bypassing SPIFFS.
+// The acquisition side publishes records into a lock-free queue; the
+// control task batches them into FRAME_TELEMETRY frames whose sequence
+// numbers let the host detect lost frames.
+class Telemetry {
+private:
+    static const size_t QUEUE_SIZE = 1024;  // ~2 s of headroom at 500 Hz
+    static const size_t RECORDS_PER_FRAME = (FRAME_MAX_PAYLOAD - 2) / RECORD_SIZE;
+    static const unsigned long FLUSH_INTERVAL_MS = 100;  // Max latency of a partial frame
+
+    SpscQueue<SampleRecord, QUEUE_SIZE> queue;
+    volatile bool streaming;
+    volatile uint32_t droppedSamples;  // Samples lost because the queue was full
+    uint32_t reportedDrops;            // Drops already announced to the host
+    uint16_t sequence;
+    uint32_t framesSent;
+    unsigned long lastFrameTime;
+    uint8_t frameBuffer[FRAME_MAX_SIZE];
+    bool debugOutput;
+
+    void sendFrame(const SampleRecord* records, size_t count);
+
+public:
+    Telemetry();
+
+    void start();
+    void stop();
+    bool isStreaming() const;
+
+    // Producer side (acquisition task) - queue one processed sample
+    void publish(const SampleRecord& record);
+
+    // Consumer side (control task) - send queued samples as far as the UART allows
+    void service();
+
+    uint32_t getFramesSent() const;
+    uint32_t getDroppedSamples() const;
+
+    // Debug output control
+    bool getDebugOutput() const;
+    void setDebugOutput(bool enable);
+};
@@ -0,0 +1,113 @@
+#include "trace.hpp"
+
+Trace::DumpState Trace::dumpState = Trace::DumpState::IDLE;
+uint32_t Trace::dumpNext = 0;
+uint32_t Trace::dumpEnd = 0;
+uint16_t Trace::dumpSequence = 0;
+uint32_t Trace::tasks[Trace::MAX_TASKS];
+size_t Trace::taskCount = 0;
+size_t Trace::tasksSent = 0;
+
+void Trace::startDump() {
+#if TRACE_BUFFER_EVENTS > 0
+  if (dumpState != DumpState::IDLE) {
+    return;
+  }
+  recording.store(false, std::memory_order_relaxed);
+  dumpState = DumpState::ARMED;
+#else
+  if (Serial) {
+    Serial.println(F("Trace disabled, build with TRACE_BUFFER_EVENTS > 0"));
+  }
+#endif
+}
+
+bool Trace::isDumping() {
+  return dumpState != DumpState::IDLE;
+}
+
+void Trace::service() {
+  if (dumpState == DumpState::IDLE || !Serial) {
+    return;
+  }
+
+  if (dumpState == DumpState::ARMED) {
+    // A producer that passed the recording check just before the pause may
+    // still be filling its slot, so the ring is read one control cycle later
+    dumpEnd = writeIndex.load(std::memory_order_relaxed);
+    dumpNext = dumpEnd > CAPACITY ? dumpEnd - CAPACITY : 0;
+    dumpSequence = 0;
+    taskCount = 0;
+    tasksSent = 0;
+    dumpState = DumpState::EVENTS;
+    return;
+  }
+
+  while (Serial.availableForWrite() >= (int)FRAME_MAX_SIZE) {
+    if (dumpState == DumpState::EVENTS) {
+      if (dumpNext < dumpEnd) {
+        sendEventFrame();
+        continue;
+      }
+      dumpState = DumpState::TASKS;
+    }
+    if (tasksSent < taskCount) {
+      sendTaskFrame(tasks[tasksSent++]);
+      continue;
+    }
+
+    sendEndFrame();
+    writeIndex.store(0, std::memory_order_relaxed);
+    dumpState = DumpState::IDLE;
+    recording.store(true, std::memory_order_relaxed);
+    return;
+  }
+}
+
+void Trace::sendEventFrame() {
+  uint8_t payload[EVENTS_PER_FRAME * TRACE_EVENT_SIZE];
+  size_t count = 0;
+  for (; count < EVENTS_PER_FRAME && dumpNext < dumpEnd; count++, dumpNext++) {
+    const TraceEvent& event = events[dumpNext & (CAPACITY - 1)];
+    encodeTraceEvent(event, payload + count * TRACE_EVENT_SIZE);
+
+    // Remember every task seen so the host can name its track
+    size_t t = 0;
+    while (t < taskCount && tasks[t] != event.task) {
+      t++;
+    }
+    if (t == taskCount && taskCount < MAX_TASKS) {
+      tasks[taskCount++] = event.task;
+    }
+  }
+
+  uint8_t frame[FRAME_MAX_SIZE];
+  size_t frameSize = encodeFrame(FRAME_TRACE_DATA, dumpSequence++, payload, count * TRACE_EVENT_SIZE, frame);
+  Serial.write(frame, frameSize);
+}
+
+void Trace::sendTaskFrame(uint32_t task) {
+  uint8_t payload[4 + TRACE_TASK_NAME_SIZE] = {};
+  writeLE32(payload, task);
+#ifdef ARDUINO_ARCH_ESP32
+  const char* name = task ? pcTaskGetName(reinterpret_cast<TaskHandle_t>((uintptr_t)task)) : "isr";
+#else
+  const char* name = "host";
+#endif
+  strncpy(reinterpret_cast<char*>(payload + 4), name, TRACE_TASK_NAME_SIZE - 1);
+
+  uint8_t frame[FRAME_MAX_SIZE];
+  size_t frameSize = encodeFrame(FRAME_TRACE_TASK, 0, payload, sizeof(payload), frame);
+  Serial.write(frame, frameSize);
+}
+
+void Trace::sendEndFrame() {
+  uint8_t payload[8];
+  uint32_t first = dumpEnd > CAPACITY ? dumpEnd - CAPACITY : 0;
+  writeLE32(payload, dumpEnd - first);
+  writeLE32(payload + 4, first);
+
+  uint8_t frame[FRAME_HEADER_SIZE + sizeof(payload) + FRAME_TRAILER_SIZE];
+  size_t frameSize = encodeFrame(FRAME_TRACE_END, dumpSequence, payload, sizeof(payload), frame);
+  Serial.write(frame, frameSize);
+}
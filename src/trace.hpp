@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "frame_codec.hpp"
+#include "trace_format.hpp"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_timer.h>
+#endif
+
+// Events kept in the trace ring (power of two), 0 compiles tracing out
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS 1024
+#endif
+
+// Always-on event trace for timelines (stage begin/end, beats, flash flushes,
+// dump chunks). Producers on either core claim a slot with one atomic add and
+// fill it in place; the ring keeps the newest TRACE_BUFFER_EVENTS events.
+// The TRACE serial command pauses recording and streams the ring as frames
+// (see trace_format.hpp) that tools/trace2json turns into Chrome trace JSON.
+class Trace {
+public:
+    static const uint32_t CAPACITY = TRACE_BUFFER_EVENTS > 0 ? TRACE_BUFFER_EVENTS : 1;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "TRACE_BUFFER_EVENTS must be a power of two");
+
+    static inline void record(TraceEventType type, uint16_t arg) {
+        if (!recording.load(std::memory_order_relaxed)) {
+            return;
+        }
+        uint32_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+        TraceEvent& event = events[index & (CAPACITY - 1)];
+#ifdef ARDUINO_ARCH_ESP32
+        event.timestamp = (uint32_t)esp_timer_get_time();
+        event.task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+        event.core = xPortGetCoreID();
+#else
+        event.timestamp = micros();
+        event.task = 0;
+        event.core = 0;
+#endif
+        event.type = static_cast<uint8_t>(type);
+        event.arg = arg;
+    }
+
+    // Control side: TRACE command, then service() once per control cycle
+    static void startDump();
+    static void service();
+    static bool isDumping();
+
+    static uint32_t getEventCount() { return writeIndex.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t EVENTS_PER_FRAME = FRAME_MAX_PAYLOAD / TRACE_EVENT_SIZE;
+    static const size_t MAX_TASKS = 16;
+
+    enum class DumpState : uint8_t { IDLE, ARMED, EVENTS, TASKS };
+
+    inline static TraceEvent events[CAPACITY];
+    inline static std::atomic<uint32_t> writeIndex{0};
+    inline static std::atomic<bool> recording{true};
+
+    static DumpState dumpState;
+    static uint32_t dumpNext;
+    static uint32_t dumpEnd;
+    static uint16_t dumpSequence;
+    static uint32_t tasks[MAX_TASKS];
+    static size_t taskCount;
+    static size_t tasksSent;
+
+    static void sendEventFrame();
+    static void sendTaskFrame(uint32_t task);
+    static void sendEndFrame();
+};
+
+// Records STAGE_BEGIN/STAGE_END around its own lifetime, see TRACE_SCOPE
+class TraceScope {
+private:
+    const ProfileStage stage;
+
+public:
+    explicit TraceScope(ProfileStage stage) : stage(stage) {
+        Trace::record(TraceEventType::STAGE_BEGIN, static_cast<uint16_t>(stage));
+    }
+    ~TraceScope() { Trace::record(TraceEventType::STAGE_END, static_cast<uint16_t>(stage)); }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if TRACE_BUFFER_EVENTS > 0
+#define TRACE_EVENT(type, arg) Trace::record(TraceEventType::type, (arg))
+#define TRACE_SCOPE(stage) TraceScope TRACE_CONCAT(traceScope, __LINE__)(ProfileStage::stage)
+#else
+#define TRACE_EVENT(type, arg) do {} while (0)
+#define TRACE_SCOPE(stage) do {} while (0)
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "profile_stage.hpp"
+#include "record_format.hpp"
+
+// Event trace wire format shared by the firmware and tools/trace2json.
+//
+// A trace dump is a run of FRAME_TRACE_DATA frames carrying whole events,
+// one FRAME_TRACE_TASK frame per task seen in them, then FRAME_TRACE_END.
+// Event layout (little-endian, TRACE_EVENT_SIZE bytes):
+//   timestamp u32 (us) | task u32 | type u8 | core u8 | arg u16
+
+static const size_t TRACE_EVENT_SIZE = 12;
+static const size_t TRACE_TASK_NAME_SIZE = 16;
+
+enum class TraceEventType : uint8_t {
+    STAGE_BEGIN = 1,  // arg: ProfileStage
+    STAGE_END,        // arg: ProfileStage
+    BEAT,             // arg: BPM of the interval ending at this beat (0 for the first)
+    FLUSH_BEGIN,      // arg: block size in bytes
+    FLUSH_END,        // arg: block size in bytes
+    DUMP_CHUNK        // arg: frame sequence number
+};
+
+struct TraceEvent {
+    uint32_t timestamp;  // Microseconds, wraps after ~71 minutes
+    uint32_t task;       // Task handle (0 outside FreeRTOS)
+    uint8_t  type;       // TraceEventType
+    uint8_t  core;
+    uint16_t arg;
+};
+
+inline void encodeTraceEvent(const TraceEvent& event, uint8_t* out) {
+    writeLE32(out, event.timestamp);
+    writeLE32(out + 4, event.task);
+    out[8] = event.type;
+    out[9] = event.core;
+    writeLE16(out + 10, event.arg);
+}
+
+inline void decodeTraceEvent(const uint8_t* in, TraceEvent& event) {
+    event.timestamp = readLE32(in);
+    event.task = readLE32(in + 4);
+    event.type = in[8];
+    event.core = in[9];
+    event.arg = readLE16(in + 10);
+}
+
+inline const char* traceEventName(const TraceEvent& event) {
+    switch (static_cast<TraceEventType>(event.type)) {
+        case TraceEventType::STAGE_BEGIN:
+        case TraceEventType::STAGE_END:
+            return profileStageName(static_cast<ProfileStage>(event.arg));
+        case TraceEventType::BEAT: return "beat";
+        case TraceEventType::FLUSH_BEGIN:
+        case TraceEventType::FLUSH_END:
+            return "flash_flush";
+        case TraceEventType::DUMP_CHUNK: return "dump_chunk";
+        default: return "?";
+    }
+}
@@ -0,0 +1,299 @@
+// Archive analyzer: memory-maps recordings (CSV, binary or compressed, see
+// src/record_format.hpp and src/column_codec.hpp), summarizes each session in a single pass and
+// writes compact files that scripts/plot_sensor_data.py --analysis reads
+// instead of parsing the CSVs with pandas.
+//
+// Usage: analyze [--out DIR] [--gap-ms MS] [--threads N] <recording | directory ...>
+//   --out DIR      output directory (default build/host/analysis)
+//   --gap-ms MS    sample-to-sample time step counted as a gap (default 1000)
+//   --threads N    worker threads (default: all cores)
+//   directory      every *.csv, *.bin, *.hbr and *.hbc file in it
+//
+// Outputs in DIR:
+//   summary.jsonl        one JSON object per session: sample and beat counts,
+//                        sensor BPM average/max, RR-interval statistics
+//                        (mean, min, max, SDNN, RMSSD), gaps
+//   <name>.samples.i32   little-endian int32, 7 per sample in CSV column
+//                        order, time relative to the first sample
+//   <name>.beats.f32     little-endian float32, 3 per beat interval: time
+//                        relative to the first sample, RR interval (ms) and
+//                        the BPM averaged over the last 10 intervals
+//
+// <name> is the recording's file name with its extension, so foo.csv and
+// foo.hbc don't overwrite each other; of several inputs with the same file
+// name (from different directories) only the first is analyzed.
+//
+// RR intervals never span a gap, so a dropped link doesn't show up as a
+// very slow beat.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+#include "csv_recording.hpp"
+#include "mapped_file.hpp"
+#include "recording_inputs.hpp"
+#include "work_stealing_pool.hpp"
+
+static const size_t SAMPLE_COLUMNS = 7;
+static const size_t BEAT_COLUMNS = 3;
+static const size_t BPM_WINDOW = 10;  // Intervals in the smoothed beat-based BPM, as on the device
+
+struct SessionSummary {
+    std::string file;
+    std::string name;
+    const char* format = "csv";
+    size_t samples = 0;
+    unsigned long startTimestamp = 0;
+    unsigned long durationMs = 0;
+    size_t beats = 0;
+    double sensorBpmSum = 0;
+    size_t sensorBpmRows = 0;
+    int sensorBpmMax = 0;
+    size_t rrCount = 0;
+    double rrSum = 0;
+    double rrSquareSum = 0;
+    double rrMin = 0;
+    double rrMax = 0;
+    double successiveSquareSum = 0;  // For RMSSD
+    size_t successiveCount = 0;
+    double lastBeatBpm = 0;          // Smoothed beat-based BPM at the end of the session
+    size_t gaps = 0;
+    unsigned long gapMs = 0;
+    unsigned long maxGapMs = 0;
+};
+
+static bool writeFile(const std::string& path, const void* data, size_t size) {
+  FILE* out = fopen(path.c_str(), "wb");
+  if (!out) {
+    return false;
+  }
+  bool ok = fwrite(data, 1, size, out) == size;
+  return fclose(out) == 0 && ok;
+}
+
+// Little-endian on every host we build for; the static_assert keeps it honest
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "outputs are written in host byte order");
+
+static bool analyzeSession(const std::string& path, const std::string& outDir, unsigned long gapThresholdMs,
+                           SessionSummary& summary) {
+  MappedFile file;
+  if (!file.open(path.c_str())) {
+    return false;
+  }
+  summary.file = path;
+  summary.name = std::filesystem::path(path).filename().string();
+  // Rough bytes per sample of each format, for the reserve below
+  size_t sampleSize = 24;
+  if (file.size() >= 4 && memcmp(file.data(), "HBR", 4) == 0) {
+    summary.format = "binary";
+    sampleSize = RECORD_SIZE;
+  } else if (file.size() >= 4 && memcmp(file.data(), "HBC", 4) == 0) {
+    summary.format = "compressed";
+    sampleSize = 3;
+  }
+
+  std::vector<int32_t> samples;
+  std::vector<float> beats;
+  samples.reserve(file.size() / sampleSize * SAMPLE_COLUMNS);
+
+  unsigned long previousTimestamp = 0;
+  unsigned long lastBeat = 0;
+  bool haveBeat = false;
+  double previousRr = 0;
+  bool havePreviousRr = false;
+  double recentBpm[BPM_WINDOW];
+  size_t recentCount = 0;
+  double recentSum = 0;
+
+  bool ok = forEachRecordingRow(file.data(), file.size(), [&](const RecordingRow& row) {
+    if (summary.samples == 0) {
+      summary.startTimestamp = row.timestamp;
+    } else {
+      unsigned long step = row.timestamp - previousTimestamp;
+      if (step > gapThresholdMs) {
+        summary.gaps++;
+        summary.gapMs += step;
+        summary.maxGapMs = std::max(summary.maxGapMs, step);
+        haveBeat = false;  // Don't measure an interval across the gap
+        havePreviousRr = false;
+      }
+    }
+    previousTimestamp = row.timestamp;
+    unsigned long relative = row.timestamp - summary.startTimestamp;
+    summary.samples++;
+
+    int32_t values[SAMPLE_COLUMNS] = {(int32_t)relative, row.signal, row.peak, row.trough,
+                                      row.threshold, row.beatDetected ? 1 : 0, row.bpm};
+    samples.insert(samples.end(), values, values + SAMPLE_COLUMNS);
+
+    if (row.bpm > 0) {
+      summary.sensorBpmSum += row.bpm;
+      summary.sensorBpmRows++;
+      summary.sensorBpmMax = std::max(summary.sensorBpmMax, row.bpm);
+    }
+    if (!row.beatDetected) {
+      return;
+    }
+
+    summary.beats++;
+    if (haveBeat && row.timestamp > lastBeat) {
+      double rr = row.timestamp - lastBeat;
+      summary.rrMin = summary.rrCount ? std::min(summary.rrMin, rr) : rr;
+      summary.rrMax = summary.rrCount ? std::max(summary.rrMax, rr) : rr;
+      summary.rrCount++;
+      summary.rrSum += rr;
+      summary.rrSquareSum += rr * rr;
+      if (havePreviousRr) {
+        summary.successiveSquareSum += (rr - previousRr) * (rr - previousRr);
+        summary.successiveCount++;
+      }
+      previousRr = rr;
+      havePreviousRr = true;
+
+      // Running window of the last BPM_WINDOW instantaneous rates
+      double bpm = 60000.0 / rr;
+      if (recentCount == BPM_WINDOW) {
+        recentSum -= recentBpm[summary.rrCount % BPM_WINDOW];
+      } else {
+        recentCount++;
+      }
+      recentBpm[summary.rrCount % BPM_WINDOW] = bpm;
+      recentSum += bpm;
+      summary.lastBeatBpm = recentSum / recentCount;
+
+      float beat[BEAT_COLUMNS] = {(float)relative, (float)rr, (float)summary.lastBeatBpm};
+      beats.insert(beats.end(), beat, beat + BEAT_COLUMNS);
+    }
+    lastBeat = row.timestamp;
+    haveBeat = true;
+  });
+  if (!ok || summary.samples == 0) {
+    return false;
+  }
+  summary.durationMs = previousTimestamp - summary.startTimestamp;
+
+  return writeFile(outDir + "/" + summary.name + ".samples.i32", samples.data(), samples.size() * sizeof(int32_t)) &&
+         writeFile(outDir + "/" + summary.name + ".beats.f32", beats.data(), beats.size() * sizeof(float));
+}
+
+// Paths come from the file system, escape what JSON requires
+static std::string jsonEscape(const std::string& text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+static void writeSummary(FILE* out, const SessionSummary& summary) {
+  double rrMean = summary.rrCount ? summary.rrSum / summary.rrCount : 0;
+  double sdnn = summary.rrCount > 1
+      ? sqrt(std::max(0.0, (summary.rrSquareSum - summary.rrSum * rrMean) / (summary.rrCount - 1))) : 0;
+  double rmssd = summary.successiveCount ? sqrt(summary.successiveSquareSum / summary.successiveCount) : 0;
+
+  fprintf(out, "{\"file\":\"%s\",\"name\":\"%s\",\"format\":\"%s\",\"samples\":%zu,\"start_ms\":%lu,"
+               "\"duration_ms\":%lu,\"beats\":%zu,\"sensor_avg_bpm\":%.2f,\"sensor_max_bpm\":%d,"
+               "\"rr_count\":%zu,\"rr_mean_ms\":%.1f,\"rr_min_ms\":%.0f,\"rr_max_ms\":%.0f,"
+               "\"sdnn_ms\":%.2f,\"rmssd_ms\":%.2f,\"last_beat_bpm\":%.2f,"
+               "\"gaps\":%zu,\"gap_ms\":%lu,\"max_gap_ms\":%lu}\n",
+          jsonEscape(summary.file).c_str(), jsonEscape(summary.name).c_str(), summary.format, summary.samples,
+          summary.startTimestamp, summary.durationMs, summary.beats,
+          summary.sensorBpmRows ? summary.sensorBpmSum / summary.sensorBpmRows : 0.0, summary.sensorBpmMax,
+          summary.rrCount, rrMean, summary.rrMin, summary.rrMax, sdnn, rmssd, summary.lastBeatBpm,
+          summary.gaps, summary.gapMs, summary.maxGapMs);
+}
+
+static void printUsage() {
+  fprintf(stderr, "Usage: analyze [--out DIR] [--gap-ms MS] [--threads N] <recording | directory ...>\n");
+}
+
+int main(int argc, char** argv) {
+  std::string outDir = "build/host/analysis";
+  unsigned long gapThresholdMs = 1000;
+  unsigned threads = 0;
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      outDir = argv[++i];
+    } else if (strcmp(argv[i], "--gap-ms") == 0 && i + 1 < argc) {
+      gapThresholdMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = (unsigned)std::max(1, atoi(argv[++i]));
+    } else if (argv[i][0] == '-') {
+      printUsage();
+      return 1;
+    } else {
+      collectRecordings(argv[i], files);
+    }
+  }
+  if (files.empty()) {
+    printUsage();
+    return 1;
+  }
+
+  // Outputs are named after the input's file name, which must be unique
+  std::set<std::string> names;
+  std::vector<std::string> unique;
+  for (const std::string& file : files) {
+    if (names.insert(std::filesystem::path(file).filename().string()).second) {
+      unique.push_back(file);
+    } else {
+      fprintf(stderr, "WARNING: Skipping %s, another input has the same file name\n", file.c_str());
+    }
+  }
+  files.swap(unique);
+
+  std::error_code error;
+  std::filesystem::create_directories(outDir, error);
+  if (error) {
+    fprintf(stderr, "ERROR: Failed to create %s\n", outDir.c_str());
+    return 1;
+  }
+
+  auto started = std::chrono::steady_clock::now();
+  std::vector<SessionSummary> summaries(files.size());
+  std::vector<char> analyzed(files.size(), 0);
+  std::atomic<size_t> bytes{0};
+  WorkStealingPool pool(threads);
+  pool.run(files.size(), [&](size_t i) {
+    analyzed[i] = analyzeSession(files[i], outDir, gapThresholdMs, summaries[i]);
+    std::error_code sizeError;
+    bytes.fetch_add(std::filesystem::file_size(files[i], sizeError), std::memory_order_relaxed);
+  });
+
+  std::string summaryPath = outDir + "/summary.jsonl";
+  FILE* out = fopen(summaryPath.c_str(), "w");
+  if (!out) {
+    fprintf(stderr, "ERROR: Failed to open output file %s\n", summaryPath.c_str());
+    return 1;
+  }
+  size_t sessions = 0;
+  size_t samples = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    if (!analyzed[i]) {
+      fprintf(stderr, "WARNING: Skipping %s, not a readable recording\n", files[i].c_str());
+      continue;
+    }
+    writeSummary(out, summaries[i]);
+    sessions++;
+    samples += summaries[i].samples;
+  }
+  fclose(out);
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  fprintf(stderr, "Analyzed %zu session(s), %zu samples (%.1f MB) in %.3f s -> %s\n",
+          sessions, samples, bytes.load() / 1e6, elapsed, summaryPath.c_str());
+  return 0;
+}
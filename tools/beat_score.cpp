@@ -0,0 +1,133 @@
+#include "beat_score.hpp"
+#include <cmath>
+#include <cstdlib>
+#include "../src/data_logger.hpp"
+#include "../src/sampler.hpp"
+#include "../src/sensor.hpp"
+
+// Beat position in time and in samples at the rate the detector ran
+struct BeatTime {
+    unsigned long timestamp;
+    double sample;
+};
+
+void BeatScore::add(const BeatScore& other) {
+  referenceBeats += other.referenceBeats;
+  detectedBeats += other.detectedBeats;
+  matchedBeats += other.matchedBeats;
+  durationMs += other.durationMs;
+  latencySumMs += other.latencySumMs;
+  latencyBiasSumMs += other.latencyBiasSumMs;
+  latencySumSamples += other.latencySumSamples;
+  maxLatencyMs = max(maxLatencyMs, other.maxLatencyMs);
+  bpmErrorSum += other.bpmErrorSum;
+  bpmRows += other.bpmRows;
+}
+
+void SensorSettings::apply(Sensor& sensor) const {
+  sensor.setThresholdOffset(thresholdOffset);
+  if (peakDecay >= 0) {
+    sensor.setPeakDecayRate(peakDecay);
+  }
+  if (troughDecay >= 0) {
+    sensor.setTroughDecayRate(troughDecay);
+  }
+  sensor.setBpmOffset(bpmOffset);
+  sensor.setFilterEnabled(filter);
+}
+
+BeatScore scoreRecording(const std::vector<RecordingRow>& rows, const SensorSettings& settings, unsigned long windowMs) {
+  BeatScore result;
+  if (rows.empty()) {
+    return result;
+  }
+
+  DataLogger dataLogger;
+  Sensor sensor(dataLogger);
+  settings.apply(sensor);
+
+  // Never started or read, only puts processSample() on the fixed-rate
+  // peak/trough decay cadence of the resampled stream
+  const bool resample = settings.filter;
+  Sampler rateSource(Sensor::getPulseInputPin());
+  if (resample) {
+    rateSource.setSampleRate(SAMPLE_RATE_HZ);
+    sensor.setSampler(&rateSource);
+  }
+
+  std::vector<BeatTime> reference;
+  std::vector<BeatTime> detected;
+  const uint64_t startUs = (uint64_t)rows.front().timestamp * 1000;
+  uint64_t samples = 0;
+  for (size_t i = 0; i < rows.size(); i++) {
+    const RecordingRow& row = rows[i];
+    if (resample) {
+      // Samples due up to this row, interpolated from the previous one
+      uint64_t rowUs = (uint64_t)row.timestamp * 1000;
+      for (;;) {
+        uint64_t sampleUs = startUs + samples * 1000000 / SAMPLE_RATE_HZ;
+        if (sampleUs > rowUs) {
+          break;
+        }
+        int value = row.signal;
+        if (i > 0) {
+          const RecordingRow& previous = rows[i - 1];
+          uint64_t previousUs = (uint64_t)previous.timestamp * 1000;
+          value = previous.signal + (int)((row.signal - previous.signal) * (int64_t)(sampleUs - previousUs) /
+                                          (int64_t)(rowUs - previousUs));
+        }
+        sensor.processSample(value, (unsigned long)(sampleUs / 1000));
+        if (sensor.isBeatDetected()) {
+          detected.push_back({(unsigned long)(sampleUs / 1000), (double)samples});
+        }
+        samples++;
+      }
+      if (row.beatDetected) {
+        reference.push_back({row.timestamp, (row.timestamp - rows.front().timestamp) * (double)SAMPLE_RATE_HZ / 1000});
+      }
+    } else {
+      sensor.processSample(row.signal, row.timestamp);
+      if (sensor.isBeatDetected()) {
+        detected.push_back({row.timestamp, (double)i});
+      }
+      if (row.beatDetected) {
+        reference.push_back({row.timestamp, (double)i});
+      }
+    }
+
+    if (row.bpm > 0) {
+      result.bpmErrorSum += abs(sensor.getBPM() - row.bpm);
+      result.bpmRows++;
+    }
+  }
+  result.referenceBeats = reference.size();
+  result.detectedBeats = detected.size();
+  result.durationMs = rows.back().timestamp - rows.front().timestamp;
+
+  // Both lists are in time order, so pair each reference beat with the
+  // nearest unused detection inside the window in one pass
+  size_t next = 0;
+  for (const BeatTime& ref : reference) {
+    while (next < detected.size() && detected[next].timestamp + windowMs < ref.timestamp) {
+      next++;
+    }
+    size_t best = detected.size();
+    for (size_t d = next; d < detected.size() && detected[d].timestamp <= ref.timestamp + windowMs; d++) {
+      if (best == detected.size() ||
+          labs((long)detected[d].timestamp - (long)ref.timestamp) < labs((long)detected[best].timestamp - (long)ref.timestamp)) {
+        best = d;
+      }
+    }
+    if (best == detected.size()) {
+      continue;
+    }
+    double latencyMs = (double)detected[best].timestamp - (double)ref.timestamp;
+    result.matchedBeats++;
+    result.latencySumMs += fabs(latencyMs);
+    result.latencyBiasSumMs += latencyMs;
+    result.latencySumSamples += fabs(detected[best].sample - ref.sample);
+    result.maxLatencyMs = max(result.maxLatencyMs, fabs(latencyMs));
+    next = best + 1;
+  }
+  return result;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Scoring of Sensor beat detection against an annotated recording, shared
+// by detect_eval and sweep. Reference beats are the rows with beat_detected
+// set; each is paired with the nearest detection within a time window.
+
+#include <vector>
+#include "csv_recording.hpp"
+
+class Sensor;
+
+struct BeatScore {
+    size_t referenceBeats = 0;
+    size_t detectedBeats = 0;
+    size_t matchedBeats = 0;
+    double durationMs = 0;
+    double latencySumMs = 0;       // |Detected - reference time|, matched beats only
+    double latencyBiasSumMs = 0;   // Detected - reference time, early and late cancel out
+    double latencySumSamples = 0;  // |Detected - reference| in detector samples
+    double maxLatencyMs = 0;
+    double bpmErrorSum = 0;        // |Sensor BPM - reference BPM| over rows with a reference
+    size_t bpmRows = 0;
+
+    double sensitivity() const { return referenceBeats ? (double)matchedBeats / referenceBeats : 1.0; }
+    double falsePositiveRate() const { return detectedBeats ? (double)(detectedBeats - matchedBeats) / detectedBeats : 0.0; }
+    double falsePositivesPerMinute() const { return durationMs > 0 ? (detectedBeats - matchedBeats) * 60000.0 / durationMs : 0.0; }
+    double f1() const { return referenceBeats + detectedBeats ? 2.0 * matchedBeats / (referenceBeats + detectedBeats) : 1.0; }
+    double latencyMs() const { return matchedBeats ? latencySumMs / matchedBeats : 0.0; }
+    double latencyBiasMs() const { return matchedBeats ? latencyBiasSumMs / matchedBeats : 0.0; }
+    double latencySamples() const { return matchedBeats ? latencySumSamples / matchedBeats : 0.0; }
+    double bpmError() const { return bpmRows ? bpmErrorSum / bpmRows : 0.0; }
+
+    void add(const BeatScore& other);
+};
+
+// Sensor parameters under test, -1 keeps the Sensor default
+struct SensorSettings {
+    int thresholdOffset = 0;
+    int peakDecay = -1;
+    int troughDecay = -1;
+    int bpmOffset = 0;
+    bool filter = false;
+
+    void apply(Sensor& sensor) const;
+};
+
+// Feed every row to a fresh Sensor through processSample() and score it.
+// With the filter on, the rows are first resampled to SAMPLE_RATE_HZ (linear
+// interpolation, like replay --sample-rate), the rate the band-pass stage is
+// designed for. Touches no shim clock or pin state, so instances can run on
+// any thread.
+BeatScore scoreRecording(const std::vector<RecordingRow>& rows, const SensorSettings& settings, unsigned long windowMs);
@@ -0,0 +1,459 @@
+// Host benchmark for the firmware hot paths, built against the Arduino shim.
+//
+// Usage: bench [--json FILE] [--baseline FILE] [--tolerance PCT] [recording.csv ...]
+//   --json FILE       also write one JSON object per benchmark to FILE
+//   --baseline FILE   compare against an earlier --json file and fail if a
+//                     benchmark got slower by more than the tolerance
+//                     (default 50 %, timings on a busy host vary a lot)
+//                     or allocates more; must not be the --json file
+//   recording.csv     input samples (default: data/examples/*.csv)
+//
+// Reports time, cycles, heap allocations and throughput per operation. The
+// legacy std::vector history is kept here as a reference point for the
+// RingBuffer version.
+
+#include <Arduino.h>
+#include <arduino_shim.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include "csv_recording.hpp"
+#include "mapped_file.hpp"
+#include "../src/biquad_filter.hpp"
+#include "../src/data_logger.hpp"
+#include "../src/display.hpp"
+#include "../src/profiler.hpp"
+#include "../src/trace.hpp"
+#include "../src/ring_buffer.hpp"
+#include "../src/sliding_min_max.hpp"
+#include "../src/sensor.hpp"
+#include "../src/simulated_sampler.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t readCycles() { return __rdtsc(); }
+#else
+static inline uint64_t readCycles() {
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+#endif
+
+// Global allocation counter - every operator new in the process goes through here.
+// noinline keeps GCC from flagging the malloc/free pairs as mismatched.
+static size_t allocationCount = 0;
+
+__attribute__((noinline)) void* operator new(size_t size) {
+  allocationCount++;
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept { free(ptr); }
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+struct BenchResult {
+    double nsPerOp;
+    double cyclesPerOp;
+    double allocationsPerOp;
+};
+
+// Machine-readable copy of every result (nullptr = table only)
+static FILE* jsonOutput = nullptr;
+
+// Results of an earlier run to compare against, by benchmark name
+static std::map<std::string, BenchResult> baseline;
+static double tolerancePercent = 50;
+static int regressions = 0;
+
+// False if the file can't be read or holds no results
+static bool loadBaseline(const char* path) {
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), in)) {
+    char name[64];
+    BenchResult result;
+    if (sscanf(line, "{\"name\":\"%63[^\"]\",\"ns_per_op\":%lf,\"cycles_per_op\":%lf,\"allocs_per_op\":%lf",
+               name, &result.nsPerOp, &result.cyclesPerOp, &result.allocationsPerOp) == 4) {
+      baseline[name] = result;
+    }
+  }
+  fclose(in);
+  return !baseline.empty();
+}
+
+static void reportResult(const char* name, const BenchResult& result) {
+  double opsPerSecond = 1e9 / result.nsPerOp;
+  printf("%-32s %10.1f ns/op %10.1f cycles/op %8.3f allocs/op %10.2f Mops/s\n",
+         name, result.nsPerOp, result.cyclesPerOp, result.allocationsPerOp, opsPerSecond / 1e6);
+  if (jsonOutput) {
+    fprintf(jsonOutput, "{\"name\":\"%s\",\"ns_per_op\":%.2f,\"cycles_per_op\":%.2f,\"allocs_per_op\":%.4f,\"ops_per_sec\":%.0f}\n",
+            name, result.nsPerOp, result.cyclesPerOp, result.allocationsPerOp, opsPerSecond);
+  }
+
+  auto previous = baseline.find(name);
+  if (previous == baseline.end()) {
+    return;
+  }
+  double change = 100.0 * (result.nsPerOp / previous->second.nsPerOp - 1.0);
+  if (change > tolerancePercent) {
+    fprintf(stderr, "REGRESSION: %s %.1f ns/op, baseline %.1f ns/op (%+.1f %%)\n",
+            name, result.nsPerOp, previous->second.nsPerOp, change);
+    regressions++;
+  }
+  // The baseline holds allocs/op rounded to the 4 decimals written above
+  if (result.allocationsPerOp >= previous->second.allocationsPerOp + 0.00005) {
+    fprintf(stderr, "REGRESSION: %s %.3f allocs/op, baseline %.3f allocs/op\n",
+            name, result.allocationsPerOp, previous->second.allocationsPerOp);
+    regressions++;
+  }
+}
+
+// Run fn(i) ops times per pass over a few passes and keep the fastest pass;
+// i keeps counting across passes so stateful code sees time moving forward
+template <typename Fn>
+static BenchResult runBenchmark(const char* name, size_t ops, Fn fn) {
+  const int PASSES = 5;
+  BenchResult best = {1e30, 1e30, 0};
+  for (int pass = 0; pass < PASSES; pass++) {
+    size_t allocationsBefore = allocationCount;
+    uint64_t cyclesBefore = readCycles();
+    auto started = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; i++) {
+      fn(pass * ops + i);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    uint64_t cycles = readCycles() - cyclesBefore;
+    if (elapsed / ops < best.nsPerOp) {
+      best = {elapsed / ops, static_cast<double>(cycles) / ops,
+              static_cast<double>(allocationCount - allocationsBefore) / ops};
+    }
+  }
+  reportResult(name, best);
+  return best;
+}
+
+// Pre-RingBuffer Sensor history handling, kept for comparison
+struct LegacyHistory {
+    std::vector<unsigned long> beatTimestamps;
+    std::vector<int> signalHistory;
+
+    void addSignal(int signal) {
+      signalHistory.push_back(signal);
+      if (signalHistory.size() > 3) {
+        signalHistory.erase(signalHistory.begin());
+      }
+    }
+
+    void addBeat(unsigned long now) {
+      beatTimestamps.push_back(now);
+      if (beatTimestamps.size() > 11) {
+        beatTimestamps.erase(beatTimestamps.begin());
+      }
+    }
+
+    int getBPM() const {
+      if (beatTimestamps.size() < 2) {
+        return 0;
+      }
+      int bpmSum = 0;
+      int count = 0;
+      for (size_t i = 0; i + 1 < beatTimestamps.size(); i++) {
+        unsigned long interval = beatTimestamps[i + 1] - beatTimestamps[i];
+        if (interval > 0) {
+          bpmSum += 60000 / interval;
+          count++;
+        }
+      }
+      return bpmSum / count;
+    }
+
+    int getSmoothedSignal() const {
+      int sum = 0;
+      for (int signal : signalHistory) {
+        sum += signal;
+      }
+      return sum / static_cast<int>(signalHistory.size());
+    }
+};
+
+// RingBuffer equivalent of LegacyHistory
+struct RingHistory {
+    RingBuffer<int, 10> intervalBpm;
+    RingBuffer<int, 3> signalHistory;
+    unsigned long lastBeat = 0;
+    bool previousBeat = false;
+
+    void addSignal(int signal) { signalHistory.push(signal); }
+
+    void addBeat(unsigned long now) {
+      if (previousBeat && now > lastBeat) {
+        intervalBpm.push(60000 / (now - lastBeat));
+      }
+      previousBeat = true;
+      lastBeat = now;
+    }
+
+    int getBPM() const { return intervalBpm.empty() ? 0 : intervalBpm.sum() / (long)intervalBpm.size(); }
+    int getSmoothedSignal() const { return signalHistory.sum() / (long)signalHistory.size(); }
+};
+
+static volatile int sink;
+
+int main(int argc, char** argv) {
+  std::vector<std::string> paths;
+  const char* jsonPath = nullptr;
+  const char* baselinePath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      jsonPath = argv[++i];
+    } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baselinePath = argv[++i];
+    } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+      tolerancePercent = atof(argv[++i]);
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    paths = {"data/examples/hearthbeat_1.csv", "data/examples/noise_1.csv"};
+  }
+
+  // Writing the results over the baseline would leave nothing to compare against
+  std::error_code error;
+  if (jsonPath && baselinePath &&
+      (strcmp(jsonPath, baselinePath) == 0 || std::filesystem::equivalent(jsonPath, baselinePath, error))) {
+    fprintf(stderr, "ERROR: --json and --baseline are the same file %s, compare against a copy\n", baselinePath);
+    return 1;
+  }
+  // The baseline is read before the output is opened, like detect_eval does
+  if (baselinePath && !loadBaseline(baselinePath)) {
+    fprintf(stderr, "ERROR: Failed to read baseline %s (missing or no results)\n", baselinePath);
+    return 1;
+  }
+  if (jsonPath && !(jsonOutput = fopen(jsonPath, "w"))) {
+    fprintf(stderr, "ERROR: Failed to open output file %s\n", jsonPath);
+    return 1;
+  }
+
+  // Concatenate all recordings into one sample stream with continuous time
+  std::vector<RecordingRow> samples;
+  unsigned long timeBase = 0;
+  for (const std::string& path : paths) {
+    std::vector<RecordingRow> rows;
+    MappedFile file;
+    if (!file.open(path.c_str()) || !parseRecording(file.data(), file.size(), rows)) {
+      fprintf(stderr, "ERROR: Failed to read samples from %s\n", path.c_str());
+      return 1;
+    }
+    for (RecordingRow row : rows) {
+      row.timestamp = timeBase + row.timestamp - rows.front().timestamp;
+      samples.push_back(row);
+    }
+    timeBase = samples.back().timestamp + 1000;
+  }
+
+  const size_t OPS = 200000;
+  const size_t count = samples.size();
+  const unsigned long loopLength = samples.back().timestamp + 1000;
+  printf("%zu samples from %zu recording(s), %zu ops per benchmark\n\n", count, paths.size(), OPS);
+
+  // Full detector step as the acquisition task runs it
+  DataLogger dataLogger;
+  Sensor sensor(dataLogger);
+  runBenchmark("sensor_update", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    sensor.processSample(row.signal, row.timestamp + (i / count) * loopLength);
+    sink = sensor.getBPM() + sensor.getSmoothedSignal();
+  });
+
+  // Same step through update() as the polling mode runs it, ADC read included
+  Sensor polledSensor(dataLogger);
+  runBenchmark("sensor_update_adc", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    shim::setMillis(row.timestamp + (i / count) * loopLength);
+    shim::setAnalogValue(Sensor::getPulseInputPin(), row.signal);
+    polledSensor.update();
+  });
+
+  // Getters the display and logging jobs call every cycle
+  runBenchmark("sensor_get_bpm", OPS, [&](size_t) {
+    sink = sensor.getBPM();
+  });
+  runBenchmark("sensor_get_smoothed_signal", OPS, [&](size_t) {
+    sink = sensor.getSmoothedSignal();
+  });
+
+  Sensor filteredSensor(dataLogger);
+  filteredSensor.setFilterEnabled(true);
+  runBenchmark("sensor_update_filtered", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    filteredSensor.processSample(row.signal, row.timestamp + (i / count) * loopLength);
+    sink = filteredSensor.getBPM() + filteredSensor.getSmoothedSignal();
+  });
+
+  // DMA-mode decimation per raw conversion, 64x oversampling, queue drained per output sample
+  SimulatedSampler oversampler(Sensor::getPulseInputPin());
+  oversampler.setOversampling(64);
+  oversampler.start();
+  AcquisitionSource::Sample decimated[32];
+  runBenchmark("oversample_conversion", OPS, [&](size_t i) {
+    shim::setAnalogValue(Sensor::getPulseInputPin(), samples[(i / 64) % count].signal);
+    oversampler.captureConversion();
+    if (oversampler.getQueuedSamples() > 0) {
+      sink = oversampler.read(decimated, 32);
+    }
+  });
+
+  // Band-pass stage alone, reported against the sample period below
+  static const BiquadCoefficients stages[2] = {
+    butterworthHighPass(0.5, SAMPLE_RATE_HZ), butterworthLowPass(5.0, SAMPLE_RATE_HZ)
+  };
+  BiquadCascade<2> bandPass(stages);
+  BenchResult filterResult = runBenchmark("bandpass_filter", OPS, [&](size_t i) {
+    sink = bandPass.process(samples[i % count].signal);
+  });
+
+  // History bookkeeping alone, old vs new
+  LegacyHistory legacy;
+  runBenchmark("history_vector_legacy", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    legacy.addSignal(row.signal);
+    if (row.beatDetected) {
+      legacy.addBeat(row.timestamp + (i / count) * loopLength);
+    }
+    sink = legacy.getBPM() + legacy.getSmoothedSignal();
+  });
+
+  RingHistory ring;
+  runBenchmark("history_ring_buffer", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    ring.addSignal(row.signal);
+    if (row.beatDetected) {
+      ring.addBeat(row.timestamp + (i / count) * loopLength);
+    }
+    sink = ring.getBPM() + ring.getSmoothedSignal();
+  });
+
+  // Signal graph autoscale, full rescan per sample vs sliding window
+  const int GRAPH_WIDTH = 128;
+  int graphHistory[GRAPH_WIDTH] = {};
+  int graphIndex = 0;
+  runBenchmark("graph_autoscale_rescan", OPS, [&](size_t i) {
+    graphHistory[graphIndex] = samples[i % count].signal;
+    graphIndex = (graphIndex + 1) % GRAPH_WIDTH;
+    int minVal = graphHistory[0];
+    int maxVal = graphHistory[0];
+    for (int j = 1; j < GRAPH_WIDTH; j++) {
+      if (graphHistory[j] < minVal) minVal = graphHistory[j];
+      if (graphHistory[j] > maxVal) maxVal = graphHistory[j];
+    }
+    sink = maxVal - minVal;
+  });
+
+  SlidingMinMax<int, 128> graphRange;
+  runBenchmark("graph_autoscale_sliding", OPS, [&](size_t i) {
+    graphRange.push(samples[i % count].signal);
+    sink = graphRange.max() - graphRange.min();
+  });
+
+  // Frame drawing per screen, everything redrawn vs cached static layers and glyphs
+  Display display(sensor, dataLogger);
+  display.init();
+  for (size_t i = 0; i < count; i++) {
+    display.updateSignalHistory(samples[i].signal, samples[i].timestamp);
+  }
+  const size_t RENDER_OPS = OPS / 100;
+  static const struct {
+      DisplaySnapshot::Screen screen;
+      const char* name;
+  } screens[] = {
+    {DisplaySnapshot::Screen::BPM, "bpm"},
+    {DisplaySnapshot::Screen::SIGNAL_GRAPH, "signal_graph"},
+    {DisplaySnapshot::Screen::MENU, "menu"},
+  };
+  for (const auto& entry : screens) {
+    DisplaySnapshot snapshot;
+    display.capture(snapshot, entry.screen, 72);
+    std::string fullName = std::string("render_") + entry.name + "_full";
+    std::string cachedName = std::string("render_") + entry.name + "_cached";
+    display.setRenderCache(false);
+    BenchResult full = runBenchmark(fullName.c_str(), RENDER_OPS, [&](size_t) {
+      display.draw(snapshot);
+    });
+    display.setRenderCache(true);
+    BenchResult cached = runBenchmark(cachedName.c_str(), RENDER_OPS, [&](size_t) {
+      display.draw(snapshot);
+    });
+    printf("%-32s %10.1f %% less time\n", "", 100.0 * (1.0 - cached.nsPerOp / full.nsPerOp));
+  }
+
+  // Whole signal graph screen, capture + draw + changed pages to the shim panel
+  runBenchmark("show_signal_graph", RENDER_OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    display.updateSignalHistory(row.signal, row.timestamp + (i / count) * loopLength);
+    display.showSignalGraph();
+  });
+
+  // Cost of one profiler scope around an empty body (PROFILE_SCOPE with -DENABLE_PROFILER)
+  runBenchmark("profile_scope", OPS, [&](size_t i) {
+    ProfileScope scope(ProfileStage::SENSOR_UPDATE);
+    sink = i;
+  });
+
+  // Cost of one always-on trace event
+  runBenchmark("trace_event", OPS, [&](size_t i) {
+    Trace::record(TraceEventType::BEAT, i);
+  });
+
+  // Per-sample recording cost, CSV text vs binary records vs compressed blocks
+  DataLogger csvLogger;
+  csvLogger.startRecording();
+  runBenchmark("logdata_csv", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    csvLogger.logData(row.timestamp, row.signal, row.peak, row.trough, row.threshold, row.beatDetected, row.bpm);
+  });
+
+  DataLogger binaryLogger;
+  binaryLogger.setRecordingFormat(DataLogger::RecordingFormat::BINARY);
+  binaryLogger.startRecording();
+  runBenchmark("logdata_binary", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    binaryLogger.logData(row.timestamp, row.signal, row.peak, row.trough, row.threshold, row.beatDetected, row.bpm);
+  });
+
+  // Includes the block encode every COLUMN_BLOCK_SAMPLES samples
+  DataLogger compressedLogger;
+  compressedLogger.setRecordingFormat(DataLogger::RecordingFormat::COMPRESSED);
+  compressedLogger.startRecording();
+  runBenchmark("logdata_compressed", OPS, [&](size_t i) {
+    const RecordingRow& row = samples[i % count];
+    compressedLogger.logData(row.timestamp, row.signal, row.peak, row.trough, row.threshold, row.beatDetected, row.bpm);
+  });
+
+  if (jsonOutput) {
+    fclose(jsonOutput);
+  }
+
+  // Host cycles depend on the machine, so this is only reported; slowdowns
+  // are caught by --baseline like every other case. The ESP32 needs several
+  // times the host cost for the 64-bit multiplies.
+  printf("\nbandpass_filter: %.1f host cycles/sample, %.4f %% of the %d Hz sample period\n",
+         filterResult.cyclesPerOp, filterResult.nsPerOp * SAMPLE_RATE_HZ / 1e7, SAMPLE_RATE_HZ);
+  if (regressions > 0) {
+    fprintf(stderr, "\nERROR: %d regression(s) against the baseline\n", regressions);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,9 @@
+#include "csv_recording.hpp"
+
+bool parseRecording(const char* data, size_t size, std::vector<RecordingRow>& rows) {
+  rows.clear();
+  forEachRecordingRow(data, size, [&](const RecordingRow& row) {
+    rows.push_back(row);
+  });
+  return !rows.empty();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include "../src/column_codec.hpp"
+#include "../src/record_format.hpp"
+
+// One row of a recorded session in the DataLogger CSV schema
+// (timestamp,signal,peak,trough,threshold,beat_detected,bpm)
+struct RecordingRow {
+    unsigned long timestamp;
+    int signal;
+    int peak;
+    int trough;
+    int threshold;
+    bool beatDetected;
+    int bpm;
+};
+
+inline RecordingRow recordingRow(const SampleRecord& record) {
+  return RecordingRow{record.timestamp, record.signal, record.peak, record.trough, record.threshold,
+                      (record.flags & RECORD_FLAG_BEAT) != 0, record.bpm};
+}
+
+// Call fn(row) for every sample of a recording held in memory (e.g. a mapped
+// file), binary (see record_format.hpp), compressed (see column_codec.hpp)
+// or CSV, without copying or reading past data + size. Returns false for a
+// binary or compressed file of an unknown version.
+template <typename Fn>
+bool forEachRecordingRow(const char* data, size_t size, Fn fn) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  if (size >= RECORD_HEADER_SIZE && memcmp(data, "HBR", 4) == 0) {
+    if (!decodeRecordHeader(bytes)) {
+      return false;
+    }
+    // A truncated last record is ignored, like hbr2csv does
+    SampleRecord record;
+    for (size_t offset = RECORD_HEADER_SIZE; offset + RECORD_SIZE <= size; offset += RECORD_SIZE) {
+      decodeRecord(bytes + offset, record);
+      fn(recordingRow(record));
+    }
+    return true;
+  }
+  if (size >= COLUMN_HEADER_SIZE && memcmp(data, "HBC", 4) == 0) {
+    if (!decodeColumnHeader(bytes)) {
+      return false;
+    }
+    // A damaged or truncated block ends the recording, like hbr2csv does
+    SampleRecord records[COLUMN_BLOCK_SAMPLES];
+    size_t offset = COLUMN_HEADER_SIZE;
+    while (offset + COLUMN_BLOCK_HEADER_SIZE <= size) {
+      size_t count = readLE16(bytes + offset);
+      size_t payloadSize = readLE16(bytes + offset + 2);
+      offset += COLUMN_BLOCK_HEADER_SIZE;
+      if (payloadSize > size - offset || !decodeColumnBlock(bytes + offset, payloadSize, count, records)) {
+        break;
+      }
+      offset += payloadSize;
+      for (size_t i = 0; i < count; i++) {
+        fn(recordingRow(records[i]));
+      }
+    }
+    return true;
+  }
+
+  const char* cursor = data;
+  const char* end = data + size;
+  while (cursor < end) {
+    const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+    if (!lineEnd) {
+      lineEnd = end;
+    }
+
+    // Skip header and anything else that doesn't start with a number
+    if (*cursor >= '0' && *cursor <= '9') {
+      long values[7] = {0};
+      for (int column = 0; column < 7 && cursor < lineEnd; column++) {
+        bool negative = *cursor == '-';
+        if (negative) {
+          cursor++;
+        }
+        long value = 0;
+        while (cursor < lineEnd && *cursor >= '0' && *cursor <= '9') {
+          value = value * 10 + (*cursor++ - '0');
+        }
+        values[column] = negative ? -value : value;
+        while (cursor < lineEnd && *cursor != ',') {
+          cursor++;
+        }
+        if (cursor < lineEnd) {
+          cursor++;
+        }
+      }
+      fn(RecordingRow{static_cast<unsigned long>(values[0]), static_cast<int>(values[1]),
+                      static_cast<int>(values[2]), static_cast<int>(values[3]),
+                      static_cast<int>(values[4]), values[5] != 0, static_cast<int>(values[6])});
+    }
+    cursor = lineEnd + 1;
+  }
+  return true;
+}
+
+// Collect the rows of a recording held in memory; returns false if no
+// sample row was found
+bool parseRecording(const char* data, size_t size, std::vector<RecordingRow>& rows);
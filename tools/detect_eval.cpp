@@ -0,0 +1,215 @@
+// Beat-detection accuracy and latency harness: replays annotated recordings
+// through Sensor and scores the detected beats against the recording's
+// beat_detected column.
+//
+// Usage: detect_eval [options] [recording ...]   (default: data/examples/*.csv; CSV, binary or compressed)
+//   --threshold-offset N  Sensor threshold offset
+//   --peak-decay N        peak decay rate
+//   --trough-decay N      trough decay rate
+//   --filter              enable the band-pass stage (rows are resampled to
+//                         SAMPLE_RATE_HZ, the rate it is designed for)
+//   --window MS           max distance between a reference and a detected beat (default 300)
+//   --json FILE           write one JSON object per recording (plus "all") to FILE
+//   --baseline FILE       compare against an earlier --json file and fail if
+//                         any metric got worse
+//
+// Per recording it reports sensitivity (matched / reference beats), the
+// false-positive rate (unmatched / detected beats), false positives per
+// minute, the mean absolute detection latency (|detected - reference time|)
+// in ms and in detector samples, its signed mean (bias: negative is early),
+// and the mean absolute BPM error over rows with a reference BPM.
+
+#include <Arduino.h>
+#include <arduino_shim.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "beat_score.hpp"
+#include "csv_recording.hpp"
+#include "mapped_file.hpp"
+
+static void printResult(const char* name, const BeatScore& result) {
+  printf("%-16s %4zu %4zu %4zu %7.1f%% %7.1f%% %7.2f %8.1f %8.1f %8.2f %8.1f %7.2f\n", name,
+         result.referenceBeats, result.detectedBeats, result.matchedBeats,
+         100.0 * result.sensitivity(), 100.0 * result.falsePositiveRate(), result.falsePositivesPerMinute(),
+         result.latencyMs(), result.latencyBiasMs(), result.latencySamples(), result.maxLatencyMs, result.bpmError());
+}
+
+static void writeJson(FILE* out, const char* name, const BeatScore& result) {
+  fprintf(out, "{\"recording\":\"%s\",\"reference_beats\":%zu,\"detected_beats\":%zu,\"matched_beats\":%zu,"
+               "\"sensitivity\":%.4f,\"fp_rate\":%.4f,\"fp_per_min\":%.3f,\"latency_ms\":%.2f,"
+               "\"latency_bias_ms\":%.2f,\"latency_samples\":%.3f,\"max_latency_ms\":%.1f,\"bpm_error\":%.3f}\n",
+          name, result.referenceBeats, result.detectedBeats, result.matchedBeats,
+          result.sensitivity(), result.falsePositiveRate(), result.falsePositivesPerMinute(),
+          result.latencyMs(), result.latencyBiasMs(), result.latencySamples(), result.maxLatencyMs, result.bpmError());
+}
+
+// Value of "key": in a JSON line written by writeJson()
+static bool jsonNumber(const char* line, const char* key, double& value) {
+  std::string pattern = std::string("\"") + key + "\":";
+  const char* found = strstr(line, pattern.c_str());
+  if (!found) {
+    return false;
+  }
+  value = strtod(found + pattern.size(), nullptr);
+  return true;
+}
+
+static bool jsonString(const char* line, const char* key, std::string& value) {
+  std::string pattern = std::string("\"") + key + "\":\"";
+  const char* found = strstr(line, pattern.c_str());
+  if (!found) {
+    return false;
+  }
+  const char* start = found + pattern.size();
+  const char* end = strchr(start, '"');
+  if (!end) {
+    return false;
+  }
+  value.assign(start, end);
+  return true;
+}
+
+struct Baseline {
+    double sensitivity;
+    double fpRate;
+    double latencyMs;
+    double bpmError;
+};
+
+static bool loadBaseline(const char* path, std::map<std::string, Baseline>& baseline) {
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    return false;
+  }
+  char line[512];
+  while (fgets(line, sizeof(line), in)) {
+    std::string name;
+    Baseline entry;
+    if (jsonString(line, "recording", name) &&
+        jsonNumber(line, "sensitivity", entry.sensitivity) &&
+        jsonNumber(line, "fp_rate", entry.fpRate) &&
+        jsonNumber(line, "latency_ms", entry.latencyMs) &&
+        jsonNumber(line, "bpm_error", entry.bpmError)) {
+      baseline[name] = entry;
+    }
+  }
+  fclose(in);
+  return true;
+}
+
+// The replay is deterministic, so anything beyond print rounding is a real change
+static int checkBaseline(const char* name, const BeatScore& result, const std::map<std::string, Baseline>& baseline) {
+  auto found = baseline.find(name);
+  if (found == baseline.end()) {
+    return 0;
+  }
+  const Baseline& base = found->second;
+  int regressions = 0;
+  auto check = [&](const char* metric, double value, double reference, bool higherIsWorse, double epsilon) {
+    double worse = higherIsWorse ? value - reference : reference - value;
+    if (worse > epsilon) {
+      fprintf(stderr, "REGRESSION: %s %s %.4f, baseline %.4f\n", name, metric, value, reference);
+      regressions++;
+    }
+  };
+  check("sensitivity", result.sensitivity(), base.sensitivity, false, 1e-3);
+  check("fp_rate", result.falsePositiveRate(), base.fpRate, true, 1e-3);
+  check("latency_ms", result.latencyMs(), base.latencyMs, true, 0.01);
+  check("bpm_error", result.bpmError(), base.bpmError, true, 1e-2);
+  return regressions;
+}
+
+static void printUsage() {
+  fprintf(stderr, "Usage: detect_eval [--threshold-offset N] [--peak-decay N] [--trough-decay N] [--filter]\n"
+                  "                   [--window MS] [--json FILE] [--baseline FILE] [recording ...]\n");
+}
+
+int main(int argc, char** argv) {
+  SensorSettings settings;
+  unsigned long windowMs = 300;
+  const char* jsonPath = nullptr;
+  const char* baselinePath = nullptr;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--threshold-offset") == 0 && i + 1 < argc) {
+      settings.thresholdOffset = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--peak-decay") == 0 && i + 1 < argc) {
+      settings.peakDecay = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--trough-decay") == 0 && i + 1 < argc) {
+      settings.troughDecay = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--filter") == 0) {
+      settings.filter = true;
+    } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+      windowMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      jsonPath = argv[++i];
+    } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baselinePath = argv[++i];
+    } else if (argv[i][0] == '-') {
+      printUsage();
+      return 1;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty()) {
+    paths = {"data/examples/hearthbeat_1.csv", "data/examples/noise_1.csv"};
+  }
+
+  std::map<std::string, Baseline> baseline;
+  if (baselinePath && !loadBaseline(baselinePath, baseline)) {
+    fprintf(stderr, "ERROR: Failed to read baseline %s\n", baselinePath);
+    return 1;
+  }
+  FILE* json = nullptr;
+  if (jsonPath && !(json = fopen(jsonPath, "w"))) {
+    fprintf(stderr, "ERROR: Failed to open output file %s\n", jsonPath);
+    return 1;
+  }
+
+  // Firmware serial chatter stays off the report
+  shim::setSerialOutput(nullptr);
+
+  printf("%-16s %4s %4s %4s %8s %8s %7s %8s %8s %8s %8s %7s\n", "recording", "ref", "det", "hit",
+         "sens", "fp rate", "fp/min", "lat ms", "bias ms", "lat smp", "max ms", "bpm err");
+  BeatScore total;
+  int regressions = 0;
+  for (const std::string& path : paths) {
+    std::vector<RecordingRow> rows;
+    MappedFile file;
+    if (!file.open(path.c_str()) || !parseRecording(file.data(), file.size(), rows)) {
+      fprintf(stderr, "ERROR: Failed to read samples from %s\n", path.c_str());
+      return 1;
+    }
+
+    // Recording name without directory and extension
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    name = name.substr(0, name.find_last_of('.'));
+
+    BeatScore result = scoreRecording(rows, settings, windowMs);
+    printResult(name.c_str(), result);
+    if (json) {
+      writeJson(json, name.c_str(), result);
+    }
+    regressions += checkBaseline(name.c_str(), result, baseline);
+    total.add(result);
+  }
+
+  printResult("all", total);
+  if (json) {
+    writeJson(json, "all", total);
+    fclose(json);
+  }
+  regressions += checkBaseline("all", total, baseline);
+
+  if (regressions > 0) {
+    fprintf(stderr, "\nERROR: %d regression(s) against the baseline\n", regressions);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Converts binary and compressed DataLogger recordings (see
+// src/record_format.hpp and src/column_codec.hpp) to the CSV schema consumed
+// by scripts/plot_sensor_data.py.
+//
+// Usage: hbr2csv <input.bin|input.hbc> [output.csv]   (default output: stdout)
+
+#include <cstdio>
+#include "../src/column_codec.hpp"
+#include "../src/record_format.hpp"
+
+static void writeRecord(FILE* out, const SampleRecord& record) {
+  char line[64];
+  formatRecordCsv(record, line, sizeof(line));
+  fprintf(out, "%s\n", line);
+}
+
+// Decode column blocks until the end of the file; a damaged or truncated
+// block ends the conversion, everything before it is kept
+static size_t convertCompressed(FILE* in, FILE* out, const char* name) {
+  static uint8_t payload[COLUMN_BLOCK_MAX_SIZE];
+  SampleRecord records[COLUMN_BLOCK_SAMPLES];
+  uint8_t header[COLUMN_BLOCK_HEADER_SIZE];
+  size_t converted = 0;
+  size_t bytesRead;
+  while ((bytesRead = fread(header, 1, sizeof(header), in)) == sizeof(header)) {
+    size_t count = readLE16(header);
+    size_t size = readLE16(header + 2);
+    if (size > sizeof(payload) || fread(payload, 1, size, in) != size ||
+        !decodeColumnBlock(payload, size, count, records)) {
+      fprintf(stderr, "WARNING: Ignoring damaged block at end of %s\n", name);
+      return converted;
+    }
+    for (size_t i = 0; i < count; i++) {
+      writeRecord(out, records[i]);
+    }
+    converted += count;
+  }
+  if (bytesRead != 0) {
+    fprintf(stderr, "WARNING: Ignoring truncated block at end of %s\n", name);
+  }
+  return converted;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    fprintf(stderr, "Usage: hbr2csv <input.bin|input.hbc> [output.csv]\n");
+    return 1;
+  }
+
+  FILE* in = fopen(argv[1], "rb");
+  if (!in) {
+    fprintf(stderr, "ERROR: Failed to open %s\n", argv[1]);
+    return 1;
+  }
+
+  uint8_t header[RECORD_HEADER_SIZE];
+  bool headerRead = fread(header, 1, sizeof(header), in) == sizeof(header);
+  bool compressed = headerRead && decodeColumnHeader(header);
+  if (!compressed && !(headerRead && decodeRecordHeader(header))) {
+    fprintf(stderr, "ERROR: %s is not a version %u binary or version %u compressed recording\n", argv[1],
+            RECORD_FORMAT_VERSION, COLUMN_FORMAT_VERSION);
+    fclose(in);
+    return 1;
+  }
+
+  FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "ERROR: Failed to open %s\n", argv[2]);
+    fclose(in);
+    return 1;
+  }
+
+  fprintf(out, "%s\n", RECORD_CSV_HEADER);
+
+  size_t records = 0;
+  if (compressed) {
+    records = convertCompressed(in, out, argv[1]);
+  } else {
+    uint8_t raw[RECORD_SIZE];
+    SampleRecord record;
+    size_t bytesRead;
+    while ((bytesRead = fread(raw, 1, sizeof(raw), in)) == sizeof(raw)) {
+      decodeRecord(raw, record);
+      writeRecord(out, record);
+      records++;
+    }
+    if (bytesRead != 0) {
+      fprintf(stderr, "WARNING: Ignoring truncated record at end of %s\n", argv[1]);
+    }
+  }
+
+  fclose(in);
+  if (out != stdout) {
+    fclose(out);
+  }
+  fprintf(stderr, "Converted %zu records\n", records);
+  return 0;
+}
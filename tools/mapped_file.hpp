@@ -0,0 +1,54 @@
+#pragma once
+
+// Read-only memory mapping of a whole file for the host tools
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+private:
+    const char* mapped = nullptr;
+    size_t length = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // Map path, returns false if it can't be opened; empty files map to size 0
+    bool open(const char* path) {
+      close();
+      int fd = ::open(path, O_RDONLY);
+      if (fd < 0) {
+        return false;
+      }
+      struct stat info;
+      bool ok = fstat(fd, &info) == 0;
+      if (ok && info.st_size > 0) {
+        void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = address != MAP_FAILED;
+        if (ok) {
+          mapped = static_cast<const char*>(address);
+          length = info.st_size;
+          madvise(address, length, MADV_SEQUENTIAL);
+        }
+      }
+      ::close(fd);  // The mapping stays valid without the descriptor
+      return ok;
+    }
+
+    void close() {
+      if (mapped) {
+        munmap(const_cast<char*>(mapped), length);
+      }
+      mapped = nullptr;
+      length = 0;
+    }
+
+    const char* data() const { return mapped; }
+    size_t size() const { return length; }
+};
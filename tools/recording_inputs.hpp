@@ -0,0 +1,35 @@
+#pragma once
+
+// Input selection shared by the host tools that take recordings or
+// directories of recordings on the command line
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Extensions of the formats forEachRecordingRow() reads: CSV, binary
+// (.bin/.hbr, see record_format.hpp) and compressed (.hbc, see column_codec.hpp)
+inline bool isRecordingFile(const std::filesystem::path& path) {
+  std::string extension = path.extension().string();
+  return extension == ".csv" || extension == ".bin" || extension == ".hbr" || extension == ".hbc";
+}
+
+// Recordings named on the command line; directories contribute every
+// recording in them, sorted by name
+inline void collectRecordings(const std::string& path, std::vector<std::string>& files) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  if (!fs::is_directory(path, error)) {
+    files.push_back(path);
+    return;
+  }
+  std::vector<std::string> found;
+  for (const fs::directory_entry& entry : fs::directory_iterator(path, error)) {
+    if (entry.is_regular_file() && isRecordingFile(entry.path())) {
+      found.push_back(entry.path().string());
+    }
+  }
+  std::sort(found.begin(), found.end());
+  files.insert(files.end(), found.begin(), found.end());
+}
@@ -0,0 +1,229 @@
+// Host replay driver: feeds a recorded CSV session into the firmware's
+// Sensor/DataLogger/Display code through the Arduino shim, as fast as the
+// host can run it.
+//
+// Usage: replay [--render] [--binary | --compressed] [--filter] [--repeat N]
+//               [--sample-rate HZ] [--oversample N] [--noise A] <input.csv> [output]
+//   --render          also render the signal graph every 100 ms of simulated time
+//   --binary          record in the binary format (decode with hbr2csv)
+//   --compressed      record in the compressed column format (decode with hbr2csv)
+//   --filter          enable the band-pass stage (designed for SAMPLE_RATE_HZ,
+//                     so combine with the matching --sample-rate)
+//   --repeat N        replay the input N times (for profiling)
+//   --sample-rate HZ  resample the input at a fixed rate through Sampler
+//                     (linear interpolation), like the timer-driven mode
+//   --oversample N    convert at N times the sample rate through SimulatedSampler
+//                     and average every N conversions, like the DMA mode
+//                     (sample rate defaults to 500 Hz)
+//   --noise A         with --oversample, add uniform +-A counts of noise to
+//                     every conversion
+//   output            recording produced by DataLogger (default: stdout)
+
+#include <Arduino.h>
+#include <arduino_shim.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "csv_recording.hpp"
+#include "mapped_file.hpp"
+#include "../src/data_logger.hpp"
+#include "../src/display.hpp"
+#include "../src/sampler.hpp"
+#include "../src/sensor.hpp"
+#include "../src/simulated_sampler.hpp"
+
+static void printUsage() {
+  fprintf(stderr, "Usage: replay [--render] [--binary | --compressed] [--filter] [--repeat N]\n"
+                  "              [--sample-rate HZ] [--oversample N] [--noise A] <input.csv> [output]\n");
+}
+
+int main(int argc, char** argv) {
+  bool render = false;
+  bool binary = false;
+  bool compressed = false;
+  bool filter = false;
+  int repeat = 1;
+  int sampleRate = 0;
+  int oversample = 0;
+  int noise = 0;
+  const char* inputPath = nullptr;
+  const char* outputPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--render") == 0) {
+      render = true;
+    } else if (strcmp(argv[i], "--binary") == 0) {
+      binary = true;
+    } else if (strcmp(argv[i], "--compressed") == 0) {
+      compressed = true;
+    } else if (strcmp(argv[i], "--filter") == 0) {
+      filter = true;
+    } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--sample-rate") == 0 && i + 1 < argc) {
+      sampleRate = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--oversample") == 0 && i + 1 < argc) {
+      oversample = max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc) {
+      noise = atoi(argv[++i]);
+    } else if (!inputPath) {
+      inputPath = argv[i];
+    } else if (!outputPath) {
+      outputPath = argv[i];
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+  if (!inputPath) {
+    printUsage();
+    return 1;
+  }
+
+  std::vector<RecordingRow> rows;
+  MappedFile input;
+  if (!input.open(inputPath) || !parseRecording(input.data(), input.size(), rows)) {
+    fprintf(stderr, "ERROR: Failed to read samples from %s\n", inputPath);
+    return 1;
+  }
+
+  // Firmware serial chatter goes to stderr, keeping stdout for the recording
+  shim::setSerialOutput(stderr);
+
+  DataLogger dataLogger;
+  Sensor sensor(dataLogger);
+  Display display(sensor, dataLogger);
+  Sampler timerSampler(Sensor::getPulseInputPin());
+  SimulatedSampler simulatedSampler(Sensor::getPulseInputPin());
+  AcquisitionSource& sampler = oversample > 0 ? static_cast<AcquisitionSource&>(simulatedSampler) : timerSampler;
+
+  display.init();
+  dataLogger.init();
+  sensor.init();
+  sensor.setFilterEnabled(filter);
+  dataLogger.setAutoRecordingTime(0);
+  if (compressed) {
+    dataLogger.setRecordingFormat(DataLogger::RecordingFormat::COMPRESSED);
+  } else if (binary) {
+    dataLogger.setRecordingFormat(DataLogger::RecordingFormat::BINARY);
+  }
+  dataLogger.startRecording();
+
+  if (oversample > 0 && sampleRate <= 0) {
+    sampleRate = 500;
+  }
+  simulatedSampler.setOversampling(oversample);
+  simulatedSampler.setNoise(noise);
+  if (sampleRate > 0) {
+    sampler.setSampleRate(sampleRate);
+    sampler.init();
+    sensor.setSampler(&sampler);
+  }
+  // Timer ticks or ADC conversions, the n-th one at captureBaseUs + n / captureRate
+  const uint64_t captureRate = oversample > 0 ? simulatedSampler.getConversionRate() : sampler.getSampleRate();
+  uint64_t captureBaseUs = 0;
+  uint64_t captures = 0;
+
+  const uint8_t pulsePin = Sensor::getPulseInputPin();
+  const unsigned long sessionLength = rows.back().timestamp - rows.front().timestamp;
+  unsigned long timeBase = rows.front().timestamp;
+  unsigned long lastDisplayUpdate = 0;
+  size_t beats = 0;
+
+  auto started = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < repeat; pass++) {
+    if (sampleRate > 0) {
+      // Restart each pass so the conversion count lines up with the session clock
+      shim::setMillis(timeBase);
+      sampler.start();
+      captureBaseUs = static_cast<uint64_t>(timeBase) * 1000;
+      captures = 0;
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+      const RecordingRow& row = rows[i];
+      unsigned long now = timeBase + row.timestamp - rows.front().timestamp;
+
+      // Emulate the sampling timer firing between the previous row and this one
+      if (sampleRate > 0 && i > 0) {
+        const RecordingRow& previous = rows[i - 1];
+        uint64_t startUs = static_cast<uint64_t>(now - (row.timestamp - previous.timestamp)) * 1000;
+        uint64_t endUs = static_cast<uint64_t>(now) * 1000;
+        for (;;) {
+          uint64_t captureUs = captureBaseUs + captures * 1000000 / captureRate;
+          if (captureUs > endUs) {
+            break;
+          }
+          int value = previous.signal + static_cast<int>((row.signal - previous.signal) *
+                      static_cast<int64_t>(captureUs - startUs) / static_cast<int64_t>(endUs - startUs));
+          shim::setMicros(captureUs);
+          shim::setAnalogValue(pulsePin, value);
+          if (oversample > 0) {
+            simulatedSampler.captureConversion();
+          } else {
+            timerSampler.captureSample();
+          }
+          captures++;
+        }
+      }
+
+      shim::setMillis(now);
+      shim::setAnalogValue(pulsePin, row.signal);
+
+      sensor.update();
+      display.updateSignalHistory(sensor.getSignalMin(), sensor.getSignalMax(), now);
+      if (sensor.isBeatDetected()) {
+        beats++;
+      }
+
+      if (render && now - lastDisplayUpdate > 100) {
+        display.showSignalGraph();
+        lastDisplayUpdate = now;
+      }
+
+      dataLogger.logData(now, sensor.getSignal(), sensor.getPeakValue(),
+                         sensor.getTroughValue(), sensor.getEffectiveThreshold(),
+                         sensor.isBeatDetected(), sensor.getBPM());
+    }
+    timeBase += sessionLength + 1000;
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  // Keep the end-of-recording dump off the console, the file is exported below
+  shim::setSerialOutput(nullptr);
+  dataLogger.stopRecording();
+  while (dataLogger.isDumping()) {
+    dataLogger.serviceDump();
+  }
+
+  std::vector<uint8_t> recording;
+  shim::readSpiffsFile(dataLogger.getDefaultFilename(), recording);
+  FILE* out = outputPath ? fopen(outputPath, "wb") : stdout;
+  if (!out) {
+    fprintf(stderr, "ERROR: Failed to open output file %s\n", outputPath);
+    return 1;
+  }
+  fwrite(recording.data(), 1, recording.size(), out);
+  if (outputPath) {
+    fclose(out);
+  }
+
+  if (sampleRate > 0 && sampler.getDroppedSamples() > 0) {
+    fprintf(stderr, "WARNING: Sampler dropped %u samples\n", (unsigned)sampler.getDroppedSamples());
+  }
+
+  if (render) {
+    const PartialSSD1306::FrameStats& frame = display.getFrameStats();
+    fprintf(stderr, "Rendered %u frames, %.1f display bytes/frame (%zu bytes on the I2C bus)\n",
+            (unsigned)frame.frames, frame.frames ? (double)frame.totalBytes / frame.frames : 0.0,
+            Wire.getBytesWritten());
+  }
+
+  size_t samples = rows.size() * repeat;
+  double simulated = (sessionLength / 1000.0) * repeat;
+  fprintf(stderr, "Replayed %zu samples (%zu beats) in %.3f s, %.0fx real time\n",
+          samples, beats, elapsed, elapsed > 0 ? simulated / elapsed : 0.0);
+  fprintf(stderr, "Recorded %zu bytes, %.2f bytes/sample\n", recording.size(), (double)recording.size() / samples);
+  return 0;
+}
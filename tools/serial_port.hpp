@@ -0,0 +1,38 @@
+#pragma once
+
+// Raw serial port helpers shared by the host tools that talk to the board
+
+#include <cstdio>
+#include <cstring>
+#include <termios.h>
+#include <unistd.h>
+
+inline speed_t baudConstant(long baud) {
+  switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return 0;
+  }
+}
+
+inline bool configurePort(int fd, long baud) {
+  termios tty;
+  if (tcgetattr(fd, &tty) != 0) {
+    return false;
+  }
+  cfmakeraw(&tty);
+  cfsetispeed(&tty, baudConstant(baud));
+  cfsetospeed(&tty, baudConstant(baud));
+  tty.c_cflag |= CLOCAL | CREAD;
+  tty.c_cc[VMIN] = 0;
+  tty.c_cc[VTIME] = 1;  // 100 ms read timeout so Ctrl+C is noticed
+  return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+inline void sendCommand(int fd, const char* command) {
+  if (write(fd, command, strlen(command)) < 0) {
+    fprintf(stderr, "WARNING: Failed to send %s", command);
+  }
+}
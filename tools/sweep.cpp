@@ -0,0 +1,209 @@
+// Parallel parameter sweep: runs an independent Sensor for every recording
+// and every combination of the detector parameters, scores each against the
+// recording's beat_detected column (see beat_score.hpp) and prints the
+// configurations ranked by detection accuracy.
+//
+// Usage: sweep [options] [recording | directory ...]
+//              (default: data/measurements, data/examples if that has no recordings;
+//              directories contribute their *.csv, *.bin, *.hbr and *.hbc files)
+//   --threshold-offset MIN:MAX:STEP  (default -200:200:25)
+//   --peak-decay MIN:MAX:STEP        (default 0:10:1)
+//   --trough-decay MIN:MAX:STEP      (default 0:10:1)
+//   --bpm-offset MIN:MAX:STEP        (default 0:0:1)
+//   --filter                         enable the band-pass stage in every run (rows are
+//                                    resampled to SAMPLE_RATE_HZ, see beat_score.hpp)
+//   --window MS                      beat matching window (default 300)
+//   --threads N                      worker threads (default: all cores)
+//   --top N                          configurations to list (default 20)
+//
+// Inputs are memory-mapped and parsed in parallel, then every
+// (configuration, recording) pair is one item on a work-stealing pool.
+// Configurations are ranked by F1 score over all recordings, then by BPM
+// error and detection latency.
+
+#include <Arduino.h>
+#include <arduino_shim.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "beat_score.hpp"
+#include "csv_recording.hpp"
+#include "mapped_file.hpp"
+#include "recording_inputs.hpp"
+#include "work_stealing_pool.hpp"
+#include "../src/sensor.hpp"
+
+struct ParameterRange {
+    int min;
+    int max;
+    int step;
+
+    size_t count() const { return (size_t)((max - min) / step) + 1; }
+    int value(size_t i) const { return min + (int)i * step; }
+};
+
+// Parse MIN:MAX:STEP (or a single value) and clamp it to the Sensor limits
+static bool parseRange(const char* text, int limitMin, int limitMax, ParameterRange& range) {
+  int values[3] = {0, 0, 1};
+  int parsed = sscanf(text, "%d:%d:%d", &values[0], &values[1], &values[2]);
+  if (parsed < 1) {
+    return false;
+  }
+  if (parsed == 1) {
+    values[1] = values[0];
+  }
+  range.min = max(limitMin, min(limitMax, values[0]));
+  range.max = max(range.min, min(limitMax, values[1]));
+  range.step = max(1, values[2]);
+  return true;
+}
+
+struct ConfigResult {
+    SensorSettings settings;
+    BeatScore score;
+};
+
+// Best accuracy first; ties go to the lower BPM error, then the lower latency,
+// then grid order
+static bool ranksHigher(const ConfigResult& a, const ConfigResult& b) {
+  if (a.score.f1() != b.score.f1()) {
+    return a.score.f1() > b.score.f1();
+  }
+  if (a.score.bpmError() != b.score.bpmError()) {
+    return a.score.bpmError() < b.score.bpmError();
+  }
+  return a.score.latencyMs() < b.score.latencyMs();
+}
+
+static void printUsage() {
+  fprintf(stderr, "Usage: sweep [--threshold-offset MIN:MAX:STEP] [--peak-decay MIN:MAX:STEP]\n"
+                  "             [--trough-decay MIN:MAX:STEP] [--bpm-offset MIN:MAX:STEP] [--filter]\n"
+                  "             [--window MS] [--threads N] [--top N] [recording | directory ...]\n");
+}
+
+int main(int argc, char** argv) {
+  ParameterRange thresholdRange = {-200, 200, 25};
+  ParameterRange peakRange = {0, 10, 1};
+  ParameterRange troughRange = {0, 10, 1};
+  ParameterRange bpmRange = {0, 0, 1};
+  bool filter = false;
+  unsigned long windowMs = 300;
+  unsigned threads = 0;
+  size_t top = 20;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    bool ok = true;
+    if (strcmp(argv[i], "--threshold-offset") == 0 && i + 1 < argc) {
+      ok = parseRange(argv[++i], Sensor::getThresholdOffsetMin(), Sensor::getThresholdOffsetMax(), thresholdRange);
+    } else if (strcmp(argv[i], "--peak-decay") == 0 && i + 1 < argc) {
+      ok = parseRange(argv[++i], Sensor::getPeakDecayMin(), Sensor::getPeakDecayMax(), peakRange);
+    } else if (strcmp(argv[i], "--trough-decay") == 0 && i + 1 < argc) {
+      ok = parseRange(argv[++i], Sensor::getTroughDecayMin(), Sensor::getTroughDecayMax(), troughRange);
+    } else if (strcmp(argv[i], "--bpm-offset") == 0 && i + 1 < argc) {
+      ok = parseRange(argv[++i], Sensor::getBpmOffsetMin(), Sensor::getBpmOffsetMax(), bpmRange);
+    } else if (strcmp(argv[i], "--filter") == 0) {
+      filter = true;
+    } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+      windowMs = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = (unsigned)max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+      top = (size_t)max(1, atoi(argv[++i]));
+    } else if (argv[i][0] == '-') {
+      ok = false;
+    } else {
+      paths.push_back(argv[i]);
+    }
+    if (!ok) {
+      printUsage();
+      return 1;
+    }
+  }
+
+  std::vector<std::string> files;
+  if (paths.empty()) {
+    collectRecordings("data/measurements", files);
+    if (files.empty()) {
+      collectRecordings("data/examples", files);
+    }
+  }
+  for (const std::string& path : paths) {
+    collectRecordings(path, files);
+  }
+  if (files.empty()) {
+    fprintf(stderr, "ERROR: No recordings found\n");
+    return 1;
+  }
+
+  // Firmware serial chatter stays off the report
+  shim::setSerialOutput(nullptr);
+
+  WorkStealingPool pool(threads);
+  auto started = std::chrono::steady_clock::now();
+
+  std::vector<std::vector<RecordingRow>> recordings(files.size());
+  std::vector<char> loaded(files.size(), 0);
+  pool.run(files.size(), [&](size_t i) {
+    MappedFile file;
+    loaded[i] = file.open(files[i].c_str()) && parseRecording(file.data(), file.size(), recordings[i]);
+  });
+  size_t rowCount = 0;
+  for (size_t i = 0; i < files.size(); i++) {
+    if (!loaded[i]) {
+      fprintf(stderr, "ERROR: Failed to read samples from %s\n", files[i].c_str());
+      return 1;
+    }
+    rowCount += recordings[i].size();
+  }
+
+  // Every combination of the four ranges, threshold offset varying slowest
+  std::vector<ConfigResult> configs;
+  for (size_t t = 0; t < thresholdRange.count(); t++) {
+    for (size_t p = 0; p < peakRange.count(); p++) {
+      for (size_t r = 0; r < troughRange.count(); r++) {
+        for (size_t b = 0; b < bpmRange.count(); b++) {
+          ConfigResult config;
+          config.settings.thresholdOffset = thresholdRange.value(t);
+          config.settings.peakDecay = peakRange.value(p);
+          config.settings.troughDecay = troughRange.value(r);
+          config.settings.bpmOffset = bpmRange.value(b);
+          config.settings.filter = filter;
+          configs.push_back(config);
+        }
+      }
+    }
+  }
+
+  // One item per (configuration, recording); each writes only its own slot
+  const size_t items = configs.size() * files.size();
+  std::vector<BeatScore> scores(items);
+  pool.run(items, [&](size_t i) {
+    scores[i] = scoreRecording(recordings[i % files.size()], configs[i / files.size()].settings, windowMs);
+  });
+  for (size_t i = 0; i < items; i++) {
+    configs[i / files.size()].score.add(scores[i]);
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+  std::stable_sort(configs.begin(), configs.end(), ranksHigher);
+
+  printf("%zu configurations x %zu recordings (%zu samples) on %u threads: %.2f s, %.0f runs/s, %zu steals\n\n",
+         configs.size(), files.size(), rowCount, pool.getThreadCount(), elapsed,
+         items / elapsed, pool.getSteals());
+  printf("%4s %9s %6s %6s %6s %7s %7s %8s %8s %8s\n", "rank", "threshold", "peak", "trough", "bpm",
+         "f1", "sens", "fp rate", "lat ms", "bpm err");
+  for (size_t i = 0; i < min(top, configs.size()); i++) {
+    const ConfigResult& config = configs[i];
+    printf("%4zu %9d %6d %6d %6d %7.3f %6.1f%% %7.1f%% %8.1f %8.2f\n", i + 1,
+           config.settings.thresholdOffset, config.settings.peakDecay, config.settings.troughDecay,
+           config.settings.bpmOffset, config.score.f1(), 100.0 * config.score.sensitivity(),
+           100.0 * config.score.falsePositiveRate(), config.score.latencyMs(), config.score.bpmError());
+  }
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Receives the live telemetry stream (FRAME_TELEMETRY frames, see
+// src/telemetry.hpp) and writes every sample to a CSV or binary recording.
+//
+// Usage: telemetry_receiver [--baud BAUD] [--binary] <port|capture|-> <output>
+//
+// A serial port is configured raw at BAUD, streaming is switched on with
+// "STREAM ON" and off again on Ctrl+C. A file or "-" (stdin) is read until
+// EOF, e.g. to decode a captured session. Text lines from the board are
+// passed through to stderr; lost frames and samples are reported at the end.
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../src/frame_codec.hpp"
+#include "../src/record_format.hpp"
+#include "serial_port.hpp"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) { stopRequested = 1; }
+
+int main(int argc, char** argv) {
+  long baud = 921600;
+  bool binary = false;
+  const char* inputPath = nullptr;
+  const char* outputPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+      baud = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--binary") == 0) {
+      binary = true;
+    } else if (!inputPath) {
+      inputPath = argv[i];
+    } else if (!outputPath) {
+      outputPath = argv[i];
+    } else {
+      inputPath = nullptr;
+      break;
+    }
+  }
+  if (!inputPath || !outputPath || baudConstant(baud) == 0) {
+    fprintf(stderr, "Usage: telemetry_receiver [--baud 115200|230400|460800|921600] [--binary] <port|capture|-> <output>\n");
+    return 1;
+  }
+
+  int fd = strcmp(inputPath, "-") == 0 ? STDIN_FILENO : open(inputPath, O_RDWR | O_NOCTTY);
+  if (fd < 0) {
+    fprintf(stderr, "ERROR: Failed to open %s: %s\n", inputPath, strerror(errno));
+    return 1;
+  }
+  struct stat info;
+  bool isPort = fstat(fd, &info) == 0 && S_ISCHR(info.st_mode) && isatty(fd);
+  if (isPort && !configurePort(fd, baud)) {
+    fprintf(stderr, "ERROR: Failed to configure %s\n", inputPath);
+    return 1;
+  }
+
+  FILE* out = fopen(outputPath, binary ? "wb" : "w");
+  if (!out) {
+    fprintf(stderr, "ERROR: Failed to open %s\n", outputPath);
+    return 1;
+  }
+  if (binary) {
+    uint8_t header[RECORD_HEADER_SIZE];
+    encodeRecordHeader(header);
+    fwrite(header, 1, sizeof(header), out);
+  } else {
+    fprintf(out, "%s\n", RECORD_CSV_HEADER);
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  if (isPort) {
+    sendCommand(fd, "STREAM ON\n");
+    fprintf(stderr, "Streaming from %s at %ld baud, Ctrl+C to stop\n", inputPath, baud);
+  }
+
+  FrameDecoder decoder;
+  bool haveSequence = false;
+  uint16_t expectedSequence = 0;
+  size_t frames = 0;
+  size_t samples = 0;
+  size_t lostFrames = 0;
+  size_t boardDrops = 0;
+  size_t badFrames = 0;
+
+  uint8_t chunk[4096];
+  char line[64];
+  SampleRecord record;
+  while (!stopRequested) {
+    ssize_t count = read(fd, chunk, sizeof(chunk));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count < 0 || (count == 0 && !isPort)) {
+      break;
+    }
+
+    for (ssize_t i = 0; i < count; i++) {
+      switch (decoder.feed(chunk[i])) {
+        case FrameDecoder::TEXT_BYTE:
+          fputc(decoder.lastTextByte(), stderr);
+          break;
+        case FrameDecoder::FRAME_BAD_CRC:
+          badFrames++;
+          break;
+        case FrameDecoder::FRAME_OK: {
+          if (decoder.type() != FRAME_TELEMETRY || decoder.payloadLength() < 2) {
+            break;
+          }
+          // A sequence gap means whole frames were lost on the link
+          if (haveSequence && decoder.seq() != expectedSequence) {
+            lostFrames += (uint16_t)(decoder.seq() - expectedSequence);
+          }
+          haveSequence = true;
+          expectedSequence = decoder.seq() + 1;
+          frames++;
+
+          const uint8_t* payload = decoder.payload();
+          boardDrops += readLE16(payload);
+          size_t records = (decoder.payloadLength() - 2) / RECORD_SIZE;
+          for (size_t r = 0; r < records; r++) {
+            const uint8_t* raw = payload + 2 + r * RECORD_SIZE;
+            if (binary) {
+              fwrite(raw, 1, RECORD_SIZE, out);
+            } else {
+              decodeRecord(raw, record);
+              formatRecordCsv(record, line, sizeof(line));
+              fprintf(out, "%s\n", line);
+            }
+          }
+          samples += records;
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+
+  if (isPort) {
+    sendCommand(fd, "STREAM OFF\n");
+  }
+  if (fd != STDIN_FILENO) {
+    close(fd);
+  }
+  fclose(out);
+
+  fprintf(stderr, "\nReceived %zu samples in %zu frames\n", samples, frames);
+  fprintf(stderr, "Lost frames: %zu, corrupted frames: %zu, samples dropped on the board: %zu\n",
+          lostFrames, badFrames, boardDrops);
+  return 0;
+}
@@ -0,0 +1,222 @@
+// Fetches the firmware event trace (TRACE command, see src/trace.hpp) and
+// writes it as Chrome trace-event JSON, viewable in ui.perfetto.dev or
+// chrome://tracing.
+//
+// Usage: trace2json [--baud BAUD] <port|capture|-> <output.json>
+//
+// A serial port is configured raw at BAUD and sent "TRACE"; a file or "-"
+// (stdin) holding a captured dump is read instead. The first complete dump
+// is converted. Each FreeRTOS task becomes a track named after the task;
+// stages and flash flushes are slices, beats and dump chunks are instants.
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "../src/frame_codec.hpp"
+#include "../src/trace_format.hpp"
+#include "serial_port.hpp"
+
+// Give up on a port that stays silent this long after the request
+static const int PORT_TIMEOUT_READS = 50;  // x 100 ms
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) { stopRequested = 1; }
+
+static void writeEvent(FILE* out, bool& first, const TraceEvent& event, uint64_t ts, const char* phase) {
+  const TraceEventType type = static_cast<TraceEventType>(event.type);
+  fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%llu,\"pid\":1,\"tid\":%u",
+          first ? "" : ",", traceEventName(event), phase, (unsigned long long)ts, (unsigned)event.task);
+  first = false;
+
+  switch (type) {
+    case TraceEventType::STAGE_BEGIN:
+    case TraceEventType::STAGE_END:
+      fprintf(out, ",\"cat\":\"stage\",\"args\":{\"core\":%u}}", event.core);
+      break;
+    case TraceEventType::FLUSH_BEGIN:
+    case TraceEventType::FLUSH_END:
+      fprintf(out, ",\"cat\":\"flash\",\"args\":{\"core\":%u,\"bytes\":%u}}", event.core, event.arg);
+      break;
+    case TraceEventType::BEAT:
+      fprintf(out, ",\"cat\":\"sensor\",\"s\":\"g\",\"args\":{\"bpm\":%u}}", event.arg);
+      break;
+    default:
+      fprintf(out, ",\"cat\":\"dump\",\"s\":\"t\",\"args\":{\"seq\":%u}}", event.arg);
+      break;
+  }
+}
+
+int main(int argc, char** argv) {
+  long baud = 921600;
+  const char* inputPath = nullptr;
+  const char* outputPath = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+      baud = atol(argv[++i]);
+    } else if (!inputPath) {
+      inputPath = argv[i];
+    } else if (!outputPath) {
+      outputPath = argv[i];
+    } else {
+      inputPath = nullptr;
+      break;
+    }
+  }
+  if (!inputPath || !outputPath || baudConstant(baud) == 0) {
+    fprintf(stderr, "Usage: trace2json [--baud 115200|230400|460800|921600] <port|capture|-> <output.json>\n");
+    return 1;
+  }
+
+  int fd = strcmp(inputPath, "-") == 0 ? STDIN_FILENO : open(inputPath, O_RDWR | O_NOCTTY);
+  if (fd < 0) {
+    fprintf(stderr, "ERROR: Failed to open %s: %s\n", inputPath, strerror(errno));
+    return 1;
+  }
+  struct stat info;
+  bool isPort = fstat(fd, &info) == 0 && S_ISCHR(info.st_mode) && isatty(fd);
+  if (isPort && !configurePort(fd, baud)) {
+    fprintf(stderr, "ERROR: Failed to configure %s\n", inputPath);
+    return 1;
+  }
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  if (isPort) {
+    sendCommand(fd, "TRACE\n");
+  }
+
+  // Collect one dump
+  FrameDecoder decoder;
+  std::vector<TraceEvent> events;
+  std::map<uint32_t, std::string> taskNames;
+  bool complete = false;
+  uint32_t overwritten = 0;
+  uint16_t expectedSequence = 0;
+  size_t lostFrames = 0;
+  size_t badFrames = 0;
+  int idleReads = 0;
+
+  uint8_t chunk[4096];
+  while (!complete && !stopRequested) {
+    ssize_t count = read(fd, chunk, sizeof(chunk));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count < 0 || (count == 0 && (!isPort || ++idleReads >= PORT_TIMEOUT_READS))) {
+      break;
+    }
+    if (count > 0) {
+      idleReads = 0;
+    }
+
+    for (ssize_t i = 0; i < count && !complete; i++) {
+      FrameDecoder::Result result = decoder.feed(chunk[i]);
+      if (result == FrameDecoder::FRAME_BAD_CRC) {
+        badFrames++;
+        continue;
+      }
+      if (result != FrameDecoder::FRAME_OK) {
+        continue;
+      }
+
+      const uint8_t* payload = decoder.payload();
+      size_t length = decoder.payloadLength();
+      if (decoder.type() == FRAME_TRACE_DATA) {
+        if (decoder.seq() != expectedSequence) {
+          lostFrames += (uint16_t)(decoder.seq() - expectedSequence);
+        }
+        expectedSequence = decoder.seq() + 1;
+        for (size_t offset = 0; offset + TRACE_EVENT_SIZE <= length; offset += TRACE_EVENT_SIZE) {
+          TraceEvent event;
+          decodeTraceEvent(payload + offset, event);
+          events.push_back(event);
+        }
+      } else if (decoder.type() == FRAME_TRACE_TASK && length >= 4 + TRACE_TASK_NAME_SIZE) {
+        char name[TRACE_TASK_NAME_SIZE + 1] = {};
+        memcpy(name, payload + 4, TRACE_TASK_NAME_SIZE);
+        taskNames[readLE32(payload)] = name;
+      } else if (decoder.type() == FRAME_TRACE_END && length >= 8) {
+        if (decoder.seq() != expectedSequence) {
+          lostFrames += (uint16_t)(decoder.seq() - expectedSequence);
+        }
+        overwritten = readLE32(payload + 4);
+        complete = true;
+      }
+    }
+  }
+  if (fd != STDIN_FILENO) {
+    close(fd);
+  }
+  if (!complete) {
+    fprintf(stderr, "ERROR: No complete trace dump in %s\n", inputPath);
+    return 1;
+  }
+
+  FILE* out = fopen(outputPath, "w");
+  if (!out) {
+    fprintf(stderr, "ERROR: Failed to open %s\n", outputPath);
+    return 1;
+  }
+
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  fprintf(out, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"heartbeat monitor\"}}");
+  first = false;
+  for (const auto& task : taskNames) {
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            (unsigned)task.first, task.second.c_str());
+  }
+
+  // Timestamps are 32-bit microseconds; unwrap them relative to the first event.
+  // Ends whose begin was overwritten in the ring are dropped.
+  std::map<std::pair<uint32_t, std::string>, int> openSlices;
+  uint64_t ts = 0;
+  for (size_t i = 0; i < events.size(); i++) {
+    const TraceEvent& event = events[i];
+    if (i > 0) {
+      int32_t delta = (int32_t)(event.timestamp - events[i - 1].timestamp);
+      ts = delta < 0 && (uint64_t)-delta > ts ? 0 : ts + delta;
+    }
+    auto key = std::make_pair(event.task, std::string(traceEventName(event)));
+    switch (static_cast<TraceEventType>(event.type)) {
+      case TraceEventType::STAGE_BEGIN:
+      case TraceEventType::FLUSH_BEGIN:
+        openSlices[key]++;
+        writeEvent(out, first, event, ts, "B");
+        break;
+      case TraceEventType::STAGE_END:
+      case TraceEventType::FLUSH_END:
+        if (openSlices[key] > 0) {
+          openSlices[key]--;
+          writeEvent(out, first, event, ts, "E");
+        }
+        break;
+      case TraceEventType::BEAT:
+      case TraceEventType::DUMP_CHUNK:
+        writeEvent(out, first, event, ts, "i");
+        break;
+      default:
+        break;
+    }
+  }
+  fprintf(out, "\n]}\n");
+  fclose(out);
+
+  fprintf(stderr, "Wrote %zu events from %zu tasks spanning %.3f s to %s\n",
+          events.size(), taskNames.size(), ts / 1e6, outputPath);
+  if (overwritten || lostFrames || badFrames) {
+    fprintf(stderr, "Events overwritten in the ring: %u, lost frames: %zu, corrupted frames: %zu\n",
+            (unsigned)overwritten, lostFrames, badFrames);
+  }
+  return 0;
+}
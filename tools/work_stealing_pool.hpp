@@ -0,0 +1,102 @@
+#pragma once
+
+// Work-stealing thread pool for the host analysis tools.
+// run() splits [0, count) into one contiguous range per worker. A worker
+// takes indices from the front of its own range; once that is empty it
+// steals the back half of another worker's remaining range, so uneven
+// item costs (long and short recordings) still keep every core busy.
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+private:
+    // Own cache line per range so the owners' front pops don't false-share
+    struct alignas(64) Range {
+        std::mutex lock;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    const unsigned threadCount;
+    std::vector<Range> ranges;
+    std::atomic<size_t> steals{0};
+
+    bool takeOwn(unsigned worker, size_t& index) {
+      Range& range = ranges[worker];
+      std::lock_guard<std::mutex> guard(range.lock);
+      if (range.next == range.end) {
+        return false;
+      }
+      index = range.next++;
+      return true;
+    }
+
+    // Move the back half of some victim's range into ours and take its first index
+    bool steal(unsigned worker, size_t& index) {
+      for (unsigned offset = 1; offset < threadCount; offset++) {
+        Range& victim = ranges[(worker + offset) % threadCount];
+        size_t first;
+        size_t last;
+        {
+          std::lock_guard<std::mutex> guard(victim.lock);
+          size_t remaining = victim.end - victim.next;
+          if (remaining == 0) {
+            continue;
+          }
+          first = victim.next + remaining / 2;
+          last = victim.end;
+          victim.end = first;
+        }
+        steals.fetch_add(1, std::memory_order_relaxed);
+
+        Range& own = ranges[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.next = first + 1;
+        own.end = last;
+        index = first;
+        return true;
+      }
+      return false;
+    }
+
+    template <typename Fn>
+    void work(unsigned worker, Fn& fn) {
+      size_t index;
+      while (takeOwn(worker, index) || steal(worker, index)) {
+        fn(index);
+      }
+    }
+
+public:
+    // threads = 0 uses every hardware thread
+    explicit WorkStealingPool(unsigned threads = 0) :
+        threadCount(threads ? threads : (std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1)),
+        ranges(threadCount) {
+    }
+
+    // Call fn(i) once for every i in [0, count), from any worker thread;
+    // returns when all calls have finished
+    template <typename Fn>
+    void run(size_t count, Fn fn) {
+      for (unsigned i = 0; i < threadCount; i++) {
+        ranges[i].next = count * i / threadCount;
+        ranges[i].end = count * (i + 1) / threadCount;
+      }
+
+      std::vector<std::thread> workers;
+      for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back([this, i, &fn] { work(i, fn); });
+      }
+      work(0, fn);
+      for (std::thread& thread : workers) {
+        thread.join();
+      }
+    }
+
+    unsigned getThreadCount() const { return threadCount; }
+    size_t getSteals() const { return steals.load(std::memory_order_relaxed); }
+};